@@ -0,0 +1,120 @@
+// Clustered light assignment: froxel light lists for N point and spot lights.
+// Usage: bench_clusters [lights] [frames]   (default: 1000 lights, 200 frames)
+#include "../src/lighting/clusters.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+float randomFloat() {
+    return rand() / float(RAND_MAX);
+}
+
+double runFrames(const ClusterSettings& settings, const mat4& view, const mat4& projection, float zNear, float zFar,
+                 const std::vector<GpuLight>& lights, Arena& arena, JobSystem* jobs, int frames, ClusterLights& out) {
+    double total = 0.0;
+    for (int f = 0; f < frames; f++) {
+        arena.reset();
+        auto start = Clock::now();
+        assignClusters(settings, view, projection, zNear, zFar, lights.data(), static_cast<uint32_t>(lights.size()),
+                       arena, jobs, out);
+        total += elapsedMs(start);
+    }
+    return total / frames;
+}
+
+// Same cluster lookup as shaders/include/clusters.glsl
+int clusterOf(const ClusterLights& clusters, const mat4& view, const mat4& projection, vec3 point) {
+    vec4 clip = projection * (view * vec4{point.x, point.y, point.z, 1.0f});
+    float ndc[2] = {clip.x / clip.w, clip.y / clip.w};
+    int tiles[2] = {clusters.tilesX, clusters.tilesY};
+    int tile[2];
+    for (int axis = 0; axis < 2; axis++) {
+        tile[axis] = static_cast<int>(std::floor((ndc[axis] * 0.5f + 0.5f) * tiles[axis]));
+        if (tile[axis] < 0 || tile[axis] >= tiles[axis]) return -1;
+    }
+    float scale = clusters.slices / std::log(clusters.zFar / clusters.zNear);
+    int slice = static_cast<int>(std::floor(std::log(clip.w / clusters.zNear) * scale));
+    if (slice >= clusters.slices) return -1;
+    if (slice < 0) slice = 0;
+    return (slice * clusters.tilesY + tile[1]) * clusters.tilesX + tile[0];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // Half point, half spot lights scattered over 200 x 20 x 200 m around the camera
+    std::vector<GpuLight> lights;
+    for (size_t i = 0; i < count; i++) {
+        LightComponent light;
+        light.type = i % 2 ? LightType::Spot : LightType::Point;
+        light.color = {randomFloat(), randomFloat(), randomFloat()};
+        light.range = 2.0f + randomFloat() * 8.0f;
+        light.direction = {randomFloat() - 0.5f, -1.0f, randomFloat() - 0.5f};
+        light.outerCone = 0.6f + randomFloat() * 0.3f;
+        light.innerCone = light.outerCone + 0.05f;
+        lights.push_back(packLight(light, {randomFloat() * 200.0f - 100.0f, randomFloat() * 20.0f, randomFloat() * 200.0f - 100.0f}));
+    }
+
+    ClusterSettings settings;
+    float zNear = 0.1f, zFar = 300.0f;
+    mat4 view = lookAt({0.0f, 5.0f, 0.0f}, {0.0f, 4.0f, -10.0f}, {0.0f, 1.0f, 0.0f});
+    mat4 projection = perspective(45.0f * static_cast<float>(M_PI) / 180.0f, 16.0f / 9.0f, zNear, zFar);
+
+    Arena arena;
+    arena.init(1024 * 1024);
+    ClusterLights clusters;
+    double serial = runFrames(settings, view, projection, zNear, zFar, lights, arena, nullptr, frames, clusters);
+    JobSystem jobs;
+    jobs.init();
+    double parallel = runFrames(settings, view, projection, zNear, zFar, lights, arena, &jobs, frames, clusters);
+    unsigned int threads = jobs.threadCount();
+    jobs.shutdown();
+
+    uint32_t clusterCount = clusters.clusterCount();
+    uint32_t occupied = 0, longest = 0;
+    for (uint32_t c = 0; c < clusterCount; c++) {
+        uint32_t lightsInCluster = clusters.ranges[c * 2 + 1];
+        if (lightsInCluster) occupied++;
+        if (lightsInCluster > longest) longest = lightsInCluster;
+    }
+    std::printf("%zu lights, %dx%dx%d clusters: %u indices, %u clusters lit, %.2f lights per lit cluster (max %u)\n",
+                count, clusters.tilesX, clusters.tilesY, clusters.slices, clusters.indexCount, occupied,
+                occupied ? double(clusters.indexCount) / occupied : 0.0, longest);
+    std::printf("single thread %.3f ms   %2u threads %.3f ms\n", serial, threads, parallel);
+
+    // Every light that reaches a point in view must be in that point's cluster
+    size_t samples = 0, missing = 0;
+    for (int s = 0; s < 200000; s++) {
+        vec3 point = {randomFloat() * 200.0f - 100.0f, randomFloat() * 20.0f, randomFloat() * -150.0f};
+        int cluster = clusterOf(clusters, view, projection, point);
+        if (cluster < 0) continue;
+        uint32_t offset = clusters.ranges[cluster * 2], listed = clusters.ranges[cluster * 2 + 1];
+        for (uint32_t i = 0; i < clusters.lightCount; i++) {
+            const GpuLight& light = clusters.lights[i];
+            vec3 toPoint = point - vec3{light.position[0], light.position[1], light.position[2]};
+            float distance = length(toPoint);
+            if (distance > light.range) continue;
+            vec3 axis = {light.direction[0], light.direction[1], light.direction[2]};
+            if (distance > 0.0f && dot(toPoint * (1.0f / distance), axis) < light.cosOuter) continue;
+            samples++;
+            bool found = false;
+            for (uint32_t k = 0; k < listed && !found; k++) found = clusters.indices[offset + k] == i;
+            if (!found) missing++;
+        }
+    }
+    std::printf("%zu lit samples, %zu missing a light\n", samples, missing);
+    return missing == 0 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// Job system microbenchmarks: spawn overhead and parallelFor scaling.
+// Usage: bench_jobs [maxThreads]   (default: hardware_concurrency, capped at 64)
+#include "../src/jobs/jobs.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Empty jobs spawned from the main thread, then waited on.
+void benchSpawn(unsigned int threads) {
+    JobSystem jobs;
+    jobs.init(static_cast<int>(threads) - 1);
+
+    const int rounds = 200;
+    const int jobsPerRound = 2000;
+    std::atomic<int> sink{0};
+    std::atomic<int>* sinkPtr = &sink;
+
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        JobCounter counter;
+        for (int i = 0; i < jobsPerRound; i++) {
+            jobs.run(&counter, [sinkPtr]() { sinkPtr->fetch_add(1, std::memory_order_relaxed); });
+        }
+        jobs.wait(&counter);
+    }
+    double ms = elapsedMs(start);
+    jobs.shutdown();
+
+    double nsPerJob = ms * 1.0e6 / (double(rounds) * jobsPerRound);
+    std::printf("spawn   threads=%2u  %8.1f ns/job  (%d jobs)\n", threads, nsPerJob, sink.load());
+}
+
+// CPU-bound parallelFor over a large array to show scaling.
+double benchScaling(unsigned int threads, std::vector<float>& data) {
+    JobSystem jobs;
+    jobs.init(static_cast<int>(threads) - 1);
+
+    float* values = data.data();
+    auto start = Clock::now();
+    for (int r = 0; r < 10; r++) {
+        jobs.parallelFor(static_cast<unsigned int>(data.size()), 4096, [values](unsigned int begin, unsigned int end) {
+            for (unsigned int i = begin; i < end; i++) {
+                float v = values[i];
+                for (int k = 0; k < 32; k++) v = std::sqrt(v * v + 1.0f) * 0.5f;
+                values[i] = v;
+            }
+        });
+    }
+    double ms = elapsedMs(start);
+    jobs.shutdown();
+    return ms;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned int maxThreads = std::thread::hardware_concurrency();
+    if (argc > 1) maxThreads = static_cast<unsigned int>(std::atoi(argv[1]));
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > 64) maxThreads = 64;
+
+    std::vector<unsigned int> counts;
+    for (unsigned int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    for (unsigned int t : counts) benchSpawn(t);
+
+    std::vector<float> data(1 << 20, 1.0f);
+    double baseline = 0.0;
+    for (unsigned int t : counts) {
+        double ms = benchScaling(t, data);
+        if (baseline == 0.0) baseline = ms;
+        std::printf("scaling threads=%2u  %8.2f ms  speedup %.2fx\n", t, ms, baseline / ms);
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+// LOD chain: simplifies a UV sphere (smooth normals, one UV seam) and a
+// faceted subdivided cube (hard edges) to 50/25/12.5% the way Scene::buildLods
+// does, checking triangle counts and that no corner picked up a vertex from
+// across a seam or crease. Then sweeps selectLod's hysteresis.
+// Usage: bench_lod [subdivisions]   (default: 64, at least 32 so the faceted
+// cube has room to reach 12.5% with its creases locked)
+#include "../src/scene/lod.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int STRIDE = 8; // Position, normal, UV, as loaded from OBJ
+
+// Indexed mesh expanded to one vertex per corner, like the OBJ loader
+struct TestMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+
+    void corner(const float* vertex) {
+        indices.push_back(static_cast<unsigned int>(vertices.size() / STRIDE));
+        vertices.insert(vertices.end(), vertex, vertex + STRIDE);
+    }
+    const float* vertex(unsigned int index) const { return &vertices[index * STRIDE]; }
+};
+
+TestMesh makeSphere(int slices, int stacks) {
+    std::vector<float> grid;
+    for (int y = 0; y <= stacks; y++) {
+        float theta = static_cast<float>(M_PI) * y / stacks;
+        for (int x = 0; x <= slices; x++) {
+            // x = 0 and x = slices share a position but not u: the UV seam
+            float phi = 2.0f * static_cast<float>(M_PI) * (x % slices) / slices;
+            float n[3] = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            if (y == 0 || y == stacks) n[0] = n[2] = 0.0f;
+            float v[STRIDE] = {n[0], n[1], n[2], n[0], n[1], n[2], x / float(slices), y / float(stacks)};
+            grid.insert(grid.end(), v, v + STRIDE);
+        }
+    }
+    TestMesh mesh;
+    for (int y = 0; y < stacks; y++) {
+        for (int x = 0; x < slices; x++) {
+            int i = y * (slices + 1) + x;
+            int quad[6] = {i, i + 1, i + slices + 2, i, i + slices + 2, i + slices + 1};
+            for (int k : quad) mesh.corner(&grid[k * STRIDE]);
+        }
+    }
+    return mesh;
+}
+
+TestMesh makeFacetedCube(int cells) {
+    TestMesh mesh;
+    for (int face = 0; face < 6; face++) {
+        int axis = face / 2;
+        float sign = face % 2 ? -1.0f : 1.0f;
+        int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        auto gridVertex = [&](int x, int y, float* out) {
+            float p[3];
+            p[axis] = sign;
+            p[u] = (2.0f * x / cells - 1.0f) * sign;
+            p[v] = 2.0f * y / cells - 1.0f;
+            float n[3] = {0.0f, 0.0f, 0.0f};
+            n[axis] = sign;
+            float vertex[STRIDE] = {p[0], p[1], p[2], n[0], n[1], n[2], x / float(cells), y / float(cells)};
+            for (int k = 0; k < STRIDE; k++) out[k] = vertex[k];
+        };
+        for (int y = 0; y < cells; y++) {
+            for (int x = 0; x < cells; x++) {
+                int quad[6][2] = {{x, y}, {x + 1, y}, {x + 1, y + 1}, {x, y}, {x + 1, y + 1}, {x, y + 1}};
+                for (auto& c : quad) {
+                    float vertex[STRIDE];
+                    gridVertex(c[0], c[1], vertex);
+                    mesh.corner(vertex);
+                }
+            }
+        }
+    }
+    return mesh;
+}
+
+// Sphere: no triangle may mix u = 0 and u = 1 copies of the seam. Pole
+// corners are skipped; u is arbitrary there.
+bool sphereSeamIntact(const TestMesh& mesh, const std::vector<unsigned int>& lod) {
+    for (size_t i = 0; i < lod.size(); i += 3) {
+        float lo = 1.0f, hi = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            const float* vertex = mesh.vertex(lod[i + k]);
+            if (vertex[7] == 0.0f || vertex[7] == 1.0f) continue;
+            float uv = vertex[6];
+            lo = std::fmin(lo, uv);
+            hi = std::fmax(hi, uv);
+        }
+        if (hi - lo > 0.5f) return false;
+    }
+    return true;
+}
+
+// Cube: a triangle's corners must all carry its own face's normal
+bool cubeCreasesIntact(const TestMesh& mesh, const std::vector<unsigned int>& lod) {
+    for (size_t i = 0; i < lod.size(); i += 3) {
+        const float* p[3] = {mesh.vertex(lod[i]), mesh.vertex(lod[i + 1]), mesh.vertex(lod[i + 2])};
+        float e1[3], e2[3];
+        for (int k = 0; k < 3; k++) {
+            e1[k] = p[1][k] - p[0][k];
+            e2[k] = p[2][k] - p[0][k];
+        }
+        float face[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        float len = std::sqrt(face[0] * face[0] + face[1] * face[1] + face[2] * face[2]);
+        for (int c = 0; c < 3; c++) {
+            const float* n = p[c] + 3;
+            if (len == 0.0f || (face[0] * n[0] + face[1] * n[1] + face[2] * n[2]) / len < 0.99f) return false;
+        }
+    }
+    return true;
+}
+
+bool runChain(const char* name, const TestMesh& mesh, bool (*attributesIntact)(const TestMesh&, const std::vector<unsigned int>&)) {
+    const float ratios[MAX_LODS] = {1.0f, 0.5f, 0.25f, 0.125f};
+    bool ok = attributesIntact(mesh, mesh.indices);
+    size_t vertexCount = mesh.vertices.size() / STRIDE;
+    std::vector<unsigned int> previous = mesh.indices;
+    std::printf("%s: %zu triangles, %zu vertices\n", name, mesh.indices.size() / 3, vertexCount);
+    for (int l = 1; l < MAX_LODS; l++) {
+        size_t target = static_cast<size_t>(mesh.indices.size() * ratios[l]) / 3 * 3;
+        std::vector<unsigned int> lod;
+        auto start = Clock::now();
+        simplifyMesh(mesh.vertices.data(), vertexCount, STRIDE, previous.data(), previous.size(), target, lod);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        bool reached = lod.size() <= target;
+        bool intact = attributesIntact(mesh, lod);
+        ok = ok && reached && intact;
+        std::printf("  LOD %d  %6zu / %6zu triangles  %7.2f ms  target %s  attributes %s\n", l, lod.size() / 3,
+                    target / 3, ms, reached ? "reached" : "MISSED", intact ? "intact" : "BROKEN");
+        previous.swap(lod);
+    }
+    return ok;
+}
+
+// Sizes jittering inside the hysteresis band around each threshold must not
+// flip the LOD; sweeping down then up must visit every LOD in order
+bool checkHysteresis() {
+    LodSettings settings;
+    const int lodCount = MAX_LODS;
+    bool ok = true;
+
+    for (int l = 1; l < lodCount; l++) {
+        float threshold = settings.screenSize[l];
+        int lod = selectLod(0, lodCount, threshold * 1.05f, settings);
+        int switches = 0;
+        for (int frame = 0; frame < 1000; frame++) {
+            float jitter = ((frame * 7919) % 1000) / 1000.0f * 2.0f - 1.0f;
+            float size = threshold * (1.0f + jitter * settings.hysteresis * 0.9f);
+            int next = selectLod(lod, lodCount, size, settings);
+            if (next != lod) switches++;
+            lod = next;
+        }
+        std::printf("  threshold %.3f: %d switches over 1000 jittered frames\n", threshold, switches);
+        ok = ok && switches == 0;
+    }
+
+    int lod = 0, expected = 0;
+    for (int step = 0; step <= 400; step++) {
+        float size = step <= 200 ? 1.0f - step * 0.0049f : 0.02f + (step - 200) * 0.0049f;
+        int next = selectLod(lod, lodCount, size, settings);
+        if (next != lod) {
+            expected += step <= 200 ? 1 : -1;
+            float threshold = settings.screenSize[step <= 200 ? next : lod];
+            float margin = step <= 200 ? 1.0f - settings.hysteresis : 1.0f + settings.hysteresis;
+            bool past = step <= 200 ? size < threshold * margin : size > threshold * margin;
+            if (next != expected || !past) ok = false;
+        }
+        lod = next;
+    }
+    ok = ok && lod == 0;
+    std::printf("  sweep down and up: %s\n", ok ? "every LOD in order, past the margin" : "WRONG");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int subdivisions = argc > 1 ? std::atoi(argv[1]) : 64;
+    if (subdivisions < 32) subdivisions = 32;
+
+    bool ok = runChain("UV sphere", makeSphere(subdivisions * 2, subdivisions), sphereSeamIntact);
+    ok = runChain("faceted cube", makeFacetedCube(subdivisions / 2), cubeCreasesIntact) && ok;
+    std::printf("selectLod\n");
+    ok = checkHysteresis() && ok;
+    std::printf("%s\n", ok ? "all checks passed" : "CHECKS FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// SIMD math kernels vs their scalar reference versions.
+// Usage: bench_math [iterations]
+#include "../src/math/math.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+mat4 randomMatrix() {
+    quat q = quatFromAxisAngle({rand() / float(RAND_MAX), 1.0f, rand() / float(RAND_MAX)}, rand() / float(RAND_MAX) * 6.0f);
+    vec3 t = {rand() / float(RAND_MAX) * 10.0f, rand() / float(RAND_MAX), -5.0f};
+    vec3 s = {1.0f + rand() / float(RAND_MAX), 0.5f, 2.0f};
+    return mat4FromTRS(t, q, s);
+}
+
+float maxDiff(const mat4& a, const mat4& b) {
+    float d = 0.0f;
+    for (int i = 0; i < 16; i++) d = std::fmax(d, std::fabs(a.m[i] - b.m[i]));
+    return d;
+}
+
+void report(const char* name, double simdNs, double scalarNs, size_t ops, float error) {
+    std::printf("%-18s simd %7.2f ns  scalar %7.2f ns  speedup %.2fx  max error %g\n", name,
+                simdNs / ops, scalarNs / ops, scalarNs / simdNs, error);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+#if CISCO_MATH_AVX
+    std::printf("kernels: AVX + SSE\n");
+#elif CISCO_MATH_SSE
+    std::printf("kernels: SSE\n");
+#else
+    std::printf("kernels: scalar only\n");
+#endif
+
+    std::vector<mat4> mats(256);
+    for (auto& m : mats) m = randomMatrix();
+    volatile float sink = 0.0f;
+
+    // mat4 x mat4
+    {
+        mat4 acc = mat4Identity(), accScalar = mat4Identity();
+        float error = maxDiff(mul(mats[0], mats[1]), mulScalar(mats[0], mats[1]));
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) acc = mul(mats[i & 255], mats[(i + 7) & 255]);
+        double simd = elapsedNs(start);
+        start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) accScalar = mulScalar(mats[i & 255], mats[(i + 7) & 255]);
+        double scalar = elapsedNs(start);
+        sink = sink + acc.m[0] + accScalar.m[0];
+        report("mat4 * mat4", simd, scalar, iterations, error);
+    }
+
+    // mat4 x vec4
+    {
+        vec4 v = {1.0f, 2.0f, 3.0f, 1.0f};
+        vec4 a = mul(mats[3], v), b = mulScalar(mats[3], v);
+        float error = std::fmax(std::fmax(std::fabs(a.x - b.x), std::fabs(a.y - b.y)), std::fabs(a.z - b.z));
+        float sum = 0.0f, sumScalar = 0.0f;
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) { vec4 r = mul(mats[i & 255], v); sum += r.x + r.y + r.z; }
+        double simd = elapsedNs(start);
+        start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) { vec4 r = mulScalar(mats[i & 255], v); sumScalar += r.x + r.y + r.z; }
+        double scalar = elapsedNs(start);
+        sink = sink + sum + sumScalar;
+        report("mat4 * vec4", simd, scalar, iterations, error);
+    }
+
+    // inverse
+    {
+        mat4 inv, invScalar;
+        inverse(mats[5], inv);
+        inverseScalar(mats[5], invScalar);
+        float error = std::fmax(maxDiff(inv, invScalar), maxDiff(mul(mats[5], inv), mat4Identity()));
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) { inverse(mats[i & 255], inv); sink = sink + inv.m[0]; }
+        double simd = elapsedNs(start);
+        start = Clock::now();
+        for (size_t i = 0; i < iterations; i++) { inverseScalar(mats[i & 255], invScalar); sink = sink + invScalar.m[0]; }
+        double scalar = elapsedNs(start);
+        report("inverse", simd, scalar, iterations, error);
+    }
+
+    // Batched point transform (100k points, SoA)
+    {
+        const size_t count = 100000;
+        std::vector<float> xs(count), ys(count), zs(count), ox(count), oy(count), oz(count), sx(count), sy(count), sz(count);
+        for (size_t i = 0; i < count; i++) { xs[i] = float(i); ys[i] = float(i % 7); zs[i] = -float(i % 13); }
+        size_t rounds = iterations / 10000 + 1;
+        auto start = Clock::now();
+        for (size_t r = 0; r < rounds; r++) transformPoints(mats[r & 255], xs.data(), ys.data(), zs.data(), ox.data(), oy.data(), oz.data(), count);
+        double simd = elapsedNs(start);
+        start = Clock::now();
+        for (size_t r = 0; r < rounds; r++) transformPointsScalar(mats[r & 255], xs.data(), ys.data(), zs.data(), sx.data(), sy.data(), sz.data(), count);
+        double scalar = elapsedNs(start);
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++) error = std::fmax(error, std::fabs(ox[i] - sx[i]));
+        report("transform points", simd, scalar, rounds * count, error);
+    }
+
+    std::printf("(checksum %g)\n", double(sink));
+    return 0;
+}
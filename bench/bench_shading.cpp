@@ -0,0 +1,170 @@
+// Forward vs deferred shading under overdraw: stacked screen-filling layers
+// drawn back to front (every layer passes the depth test) lit by N point
+// lights, each path with and without the depth pre-pass. Reports the GPU time
+// of the object passes from timer queries.
+// Run from the build directory so shaders/ is found.
+// Usage: bench_shading [lights] [layers] [frames]   (default: 1000 lights, 8 layers, 200 frames)
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "../src/renderer/renderer.hpp"
+#include "../src/shader/program_cache.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+float randomFloat() {
+    return rand() / float(RAND_MAX);
+}
+
+// A subdivided unit quad in the xy plane facing +z; position + normal per vertex
+unsigned int createLayerMesh(int cells, int& indexCount, unsigned int buffers[2]) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (int y = 0; y <= cells; y++) {
+        for (int x = 0; x <= cells; x++) {
+            float vertex[6] = {x / float(cells) - 0.5f, y / float(cells) - 0.5f, 0.0f, 0.0f, 0.0f, 1.0f};
+            vertices.insert(vertices.end(), vertex, vertex + 6);
+        }
+    }
+    for (int y = 0; y < cells; y++) {
+        for (int x = 0; x < cells; x++) {
+            unsigned int i = y * (cells + 1) + x;
+            unsigned int quad[6] = {i, i + 1, i + cells + 2, i, i + cells + 2, i + cells + 1};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    indexCount = static_cast<int>(indices.size());
+
+    unsigned int vao;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(2, buffers);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    return vao;
+}
+
+void measure(Renderer& renderer, const Scene& scene, const RenderPacket& packet, GLFWwindow* window, int frames,
+             double& gpuMs, double& cpuMs) {
+    for (int i = 0; i < 10; i++) renderer.render(scene, packet); // Warm up, allocate the G-buffer
+    glFinish();
+    renderer.objectTimer.collect(true);
+    renderer.objectTimer.reset();
+
+    auto start = Clock::now();
+    for (int i = 0; i < frames; i++) {
+        renderer.render(scene, packet);
+        glfwSwapBuffers(window);
+    }
+    glFinish();
+    cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+    renderer.objectTimer.collect(true);
+    gpuMs = renderer.objectTimer.averageMs();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t lightCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1000;
+    int layers = argc > 2 ? std::atoi(argv[2]) : 8;
+    int frames = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    if (!glfwInit()) return 1;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "bench_shading", nullptr, nullptr);
+    if (!window) {
+        std::fprintf(stderr, "Failed to create a GL 4.1 context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) return 1;
+    programCache().init("shader_cache", (GLADloadproc)glfwGetProcAddress);
+
+    Renderer renderer;
+    renderer.initRenderer();
+    while (!programCache().poll()) {
+        glfwWaitEventsTimeout(0.001);
+    }
+    if (!renderer.shaderProgram || !renderer.gbufferProgram || !renderer.deferredProgram || !renderer.depthProgram) {
+        std::fprintf(stderr, "Shaders failed to build; run from the build directory\n");
+        return 1;
+    }
+
+    // Layers 0.25 apart from z = -6 toward the camera, each filling the view
+    int indexCount = 0;
+    unsigned int buffers[2];
+    unsigned int vao = createLayerMesh(32, indexCount, buffers);
+    RenderPacket packet;
+    packet.arena.init(1024 * 1024);
+    packet.view = lookAt({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f});
+    packet.projection = perspective(45.0f * static_cast<float>(M_PI) / 180.0f, 1280.0f / 720.0f, 0.1f, 100.0f);
+    packet.drawCount = static_cast<size_t>(layers);
+    packet.draws = packet.arena.allocateArray<DrawItem>(packet.drawCount);
+    for (int i = 0; i < layers; i++) {
+        float z = -6.0f + i * 0.25f;
+        DrawItem& draw = packet.draws[i];
+        draw.model = mat4FromTRS({0.0f, 0.0f, z}, quatIdentity(), {-z * 1.6f, -z * 0.9f, 1.0f});
+        draw.normal = normalMatrix(draw.model);
+        draw.VAO = vao;
+        draw.depthVAO = vao; // The depth shader only reads attribute 0
+        draw.indexOffset = 0;
+        draw.indexCount = indexCount;
+        draw.cascadeMask = 0;
+    }
+
+    // Point lights in a slab just in front of the layers
+    GpuLight* lights = packet.arena.allocateArray<GpuLight>(lightCount);
+    for (uint32_t i = 0; i < lightCount; i++) {
+        LightComponent light;
+        light.type = LightType::Point;
+        light.color = {randomFloat(), randomFloat(), randomFloat()};
+        light.intensity = 2.0f;
+        light.range = 0.5f + randomFloat() * 1.5f;
+        lights[i] = packLight(light, {randomFloat() * 8.0f - 4.0f, randomFloat() * 4.5f - 2.25f, -4.0f - randomFloat() * 2.5f});
+    }
+    ClusterSettings clusterSettings;
+    assignClusters(clusterSettings, packet.view, packet.projection, 0.1f, 100.0f, lights, lightCount, packet.arena,
+                   nullptr, packet.lights);
+
+    Scene scene; // No terrain; the renderer only draws the packet
+    std::printf("%u lights, %d layers of overdraw, %u light indices, 1280x720\n", lightCount, layers,
+                packet.lights.indexCount);
+    const char* names[2] = {"forward ", "deferred"};
+    ShadingPath paths[2] = {ShadingPath::Forward, ShadingPath::Deferred};
+    for (int p = 0; p < 2; p++) {
+        for (int prepass = 0; prepass < 2; prepass++) {
+            renderer.shading = paths[p];
+            renderer.depthPrepass = prepass != 0;
+            double gpuMs = 0.0, cpuMs = 0.0;
+            measure(renderer, scene, packet, window, frames, gpuMs, cpuMs);
+            std::printf("%s %s  objects %.3f ms GPU   frame %.3f ms\n", names[p], prepass ? "+ pre-pass" : "          ",
+                        gpuMs, cpuMs);
+        }
+    }
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(2, buffers);
+    renderer.cleanupRenderer();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
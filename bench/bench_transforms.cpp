@@ -0,0 +1,161 @@
+// Transform hierarchy update: dirty-subtree propagation vs rebuilding everything.
+// Then checks world normal matrices against the 4x4 inverse transpose.
+// Usage: bench_transforms [nodes] [frames]   (default: 100000 nodes, 200 frames)
+#include "../src/scene/transforms.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+float randomFloat() {
+    return rand() / float(RAND_MAX);
+}
+
+// Reference world matrix by walking up the parent chain
+mat4 referenceWorld(const TransformStore& store, TransformHandle handle) {
+    uint32_t i = store.slot(handle);
+    mat4 local = mat4FromTRS({store.posX[i], store.posY[i], store.posZ[i]},
+                             {store.rotX[i], store.rotY[i], store.rotZ[i], store.rotW[i]},
+                             {store.scaleX[i], store.scaleY[i], store.scaleZ[i]});
+    TransformHandle parent = store.parent(handle);
+    return store.valid(parent) ? mulScalar(referenceWorld(store, parent), local) : local;
+}
+
+vec3 randomAxis() {
+    vec3 axis = {randomFloat() * 2.0f - 1.0f, randomFloat() * 2.0f - 1.0f, randomFloat() * 2.0f - 1.0f};
+    return length(axis) > 0.01f ? normalize(axis) : vec3{0.0f, 1.0f, 0.0f};
+}
+
+vec3 mulNormal(const mat3& a, vec3 n) {
+    return {a.m[0] * n.x + a.m[3] * n.y + a.m[6] * n.z, a.m[1] * n.x + a.m[4] * n.y + a.m[7] * n.z,
+            a.m[2] * n.x + a.m[5] * n.y + a.m[8] * n.z};
+}
+
+// Largest difference between unit normals transformed by actual and by the
+// transpose of the 4x4 inverse; the store's uniform-scale shortcut is off by
+// a positive factor, which normalizing removes
+float normalError(const mat3& actual, const mat4& world) {
+    mat4 inv;
+    if (!inverse(world, inv)) return INFINITY;
+    mat3 expected = {{inv.m[0], inv.m[4], inv.m[8], inv.m[1], inv.m[5], inv.m[9], inv.m[2], inv.m[6], inv.m[10]}};
+    float error = 0.0f;
+    for (int k = 0; k < 8; k++) {
+        vec3 n = randomAxis();
+        vec3 d = normalize(mulNormal(actual, n)) - normalize(mulNormal(expected, n));
+        error = std::fmax(error, length(d));
+    }
+    return error;
+}
+
+// Random parent/child pairs with the given scales; the child's world matrix
+// composes both, so non-uniform parents shear it
+bool checkNormals(const char* name, vec3 (*randomScale)(), float tolerance) {
+    TransformStore store;
+    std::vector<TransformHandle> nodes;
+    for (int i = 0; i < 1000; i++) {
+        vec3 position = {randomFloat(), randomFloat(), randomFloat()};
+        TransformHandle parent = store.create(position, quatFromAxisAngle(randomAxis(), randomFloat() * 6.0f), randomScale());
+        TransformHandle child = store.create(position, quatFromAxisAngle(randomAxis(), randomFloat() * 6.0f), randomScale());
+        store.setParent(child, parent);
+        nodes.push_back(parent);
+        nodes.push_back(child);
+    }
+    store.updateWorldMatrices();
+
+    float storeError = 0.0f, matrixError = 0.0f;
+    for (TransformHandle node : nodes) {
+        const mat4& world = store.worldMatrix(node);
+        storeError = std::fmax(storeError, normalError(store.worldNormalMatrix(node), world));
+        matrixError = std::fmax(matrixError, normalError(normalMatrix(world), world));
+    }
+    bool ok = storeError <= tolerance && matrixError <= tolerance;
+    std::printf("normals, %-14s store %g  normalMatrix %g  %s\n", name, storeError, matrixError, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+vec3 uniformScale() {
+    float s = 0.5f + randomFloat() * 1.5f;
+    return {s, s, s};
+}
+
+vec3 nonUniformScale() {
+    return {0.25f + randomFloat() * 4.0f, 0.25f + randomFloat() * 4.0f, 0.25f + randomFloat() * 4.0f};
+}
+
+// One axis almost flattened, as for a decal or a squashed prop
+vec3 nearSingularScale() {
+    vec3 scale = {1.0f, 1.0f, 1.0f};
+    float* axis = rand() % 3 == 0 ? &scale.x : rand() % 2 ? &scale.y : &scale.z;
+    *axis = 1e-3f;
+    return scale;
+}
+
+// Moves `fraction` of the nodes, then times one update
+double runFrames(TransformStore& store, const std::vector<TransformHandle>& nodes, JobSystem* jobs,
+                 double fraction, int frames) {
+    size_t changes = static_cast<size_t>(nodes.size() * fraction);
+    double total = 0.0;
+    for (int f = 0; f < frames; f++) {
+        for (size_t c = 0; c < changes; c++) {
+            TransformHandle node = nodes[fraction >= 1.0 ? c : rand() % nodes.size()];
+            store.setPosition(node, {randomFloat(), randomFloat(), randomFloat()});
+        }
+        auto start = Clock::now();
+        store.updateWorldMatrices(jobs);
+        total += elapsedMs(start);
+    }
+    return total / frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // 100 roots, then each node hangs off a random earlier node (depth ~log n)
+    TransformStore store;
+    std::vector<TransformHandle> nodes;
+    nodes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        quat rotation = quatFromAxisAngle({0.0f, 1.0f, 0.0f}, randomFloat() * 6.0f);
+        TransformHandle node = store.create({randomFloat(), randomFloat(), randomFloat()}, rotation, {1.0f, 1.0f, 1.0f});
+        store.setLocalBounds(node, {0.0f, 0.0f, 0.0f}, 1.0f);
+        if (i >= 100) store.setParent(node, nodes[rand() % i]);
+        nodes.push_back(node);
+    }
+
+    auto start = Clock::now();
+    store.updateWorldMatrices();
+    std::printf("%zu nodes, reorder + first update: %.3f ms\n", count, elapsedMs(start));
+
+    JobSystem jobs;
+    jobs.init();
+    std::printf("single thread   1%% dirty %.3f ms   100%% dirty %.3f ms\n",
+                runFrames(store, nodes, nullptr, 0.01, frames), runFrames(store, nodes, nullptr, 1.0, frames / 10 + 1));
+    std::printf("%2u threads      1%% dirty %.3f ms   100%% dirty %.3f ms\n", jobs.threadCount(),
+                runFrames(store, nodes, &jobs, 0.01, frames), runFrames(store, nodes, &jobs, 1.0, frames / 10 + 1));
+    jobs.shutdown();
+
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i += count / 1000 + 1) {
+        mat4 expected = referenceWorld(store, nodes[i]);
+        const mat4& actual = store.worldMatrix(nodes[i]);
+        for (int k = 0; k < 16; k++) error = std::fmax(error, std::fabs(expected.m[k] - actual.m[k]));
+    }
+    std::printf("max error vs reference %g\n", error);
+
+    bool ok = checkNormals("uniform", uniformScale, 1e-4f);
+    ok = checkNormals("non-uniform", nonUniformScale, 1e-4f) && ok;
+    ok = checkNormals("near-singular", nearSingularScale, 1e-3f) && ok;
+    return ok ? 0 : 1;
+}
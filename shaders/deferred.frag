@@ -0,0 +1,38 @@
+#version 330 core
+#include "include/lighting.glsl"
+#include "include/clusters.glsl"
+#include "include/normals.glsl"
+#ifdef SHADOWS
+#include "include/shadows.glsl"
+#endif
+// Deferred lighting: the same sun and clustered lights as lighting.frag,
+// evaluated once per pixel from the G-buffer
+out vec4 FragColor;
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform mat4 viewProjection;
+uniform vec3 lightDir;
+uniform vec3 lightColor;
+uniform vec3 ambientColor;
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0) discard; // Nothing drawn; keep the clear color
+    gl_FragDepth = depth;      // Forward passes after this test against the scene
+
+    vec2 ndc = gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    vec3 position = world.xyz / world.w;
+    vec3 normal = decodeNormal(texelFetch(gNormal, pixel, 0).rg);
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+
+    vec4 clip = viewProjection * vec4(position, 1.0);
+    vec3 sun = lightColor;
+#ifdef SHADOWS
+    sun *= sunShadow(position, normal, clip.w);
+#endif
+    vec3 light = directionalLight(normal, lightDir, sun, ambientColor) + clusteredLights(position, normal, clip);
+    FragColor = vec4(light * albedo, 1.0);
+}
@@ -0,0 +1,4 @@
+#version 330 core
+// Depth is all the shadow map needs
+void main() {
+}
@@ -0,0 +1,11 @@
+#version 330 core
+// Depth-only passes (shadow casters, depth pre-pass); positions only. The
+// transform matches lighting.vert exactly so GL_EQUAL depth tests pass.
+layout(location = 0) in vec3 aPos;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+invariant gl_Position;
+void main() {
+    gl_Position = projection * (view * (model * vec4(aPos, 1.0)));
+}
@@ -0,0 +1,11 @@
+#version 330 core
+#include "include/normals.glsl"
+// Deferred geometry pass; vertices come from lighting.vert
+layout(location = 0) out vec4 gAlbedo;
+layout(location = 1) out vec2 gNormal;
+in vec3 Normal;
+uniform vec3 objectColor;
+void main() {
+    gAlbedo = vec4(objectColor, 1.0);
+    gNormal = encodeNormal(normalize(Normal));
+}
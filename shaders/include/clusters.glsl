@@ -0,0 +1,43 @@
+// Clustered point and spot lights (see lighting/clusters.hpp). Each froxel
+// lists the lights reaching it; a fragment loops over its froxel's list only.
+uniform samplerBuffer clusterLights;   // Three texels per light: position + range, color + cos outer, direction + cos inner
+uniform usamplerBuffer clusterRanges;  // Offset and count into clusterIndices, per cluster
+uniform usamplerBuffer clusterIndices; // Light indices grouped by cluster
+uniform ivec3 clusterGrid;             // Tiles x, tiles y, depth slices
+uniform vec2 clusterDepth;             // zNear, slices / log(zFar / zNear)
+
+// -1 beyond the last slice
+int clusterIndex(vec2 ndc, float viewDepth) {
+    ivec2 tile = clamp(ivec2(floor((ndc * 0.5 + 0.5) * vec2(clusterGrid.xy))), ivec2(0), clusterGrid.xy - 1);
+    int slice = int(floor(log(viewDepth / clusterDepth.x) * clusterDepth.y));
+    if (slice >= clusterGrid.z) return -1;
+    slice = max(slice, 0);
+    return (slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x;
+}
+
+// Lambert diffuse from every light in the fragment's cluster; clip is the
+// fragment's interpolated clip-space position
+vec3 clusteredLights(vec3 worldPos, vec3 normal, vec4 clip) {
+    int cluster = clusterIndex(clip.xy / clip.w, clip.w);
+    if (cluster < 0) return vec3(0.0);
+    uvec2 range = texelFetch(clusterRanges, cluster).xy;
+    vec3 n = normalize(normal);
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(clusterIndices, int(range.x + i)).x) * 3;
+        vec4 positionRange = texelFetch(clusterLights, light);
+        vec4 colorOuter = texelFetch(clusterLights, light + 1);
+        vec4 directionInner = texelFetch(clusterLights, light + 2);
+
+        vec3 toLight = positionRange.xyz - worldPos;
+        float distanceSq = dot(toLight, toLight);
+        vec3 l = toLight * inversesqrt(max(distanceSq, 1e-8));
+        // Inverse square falloff windowed to reach zero at the range
+        float ratio = distanceSq / (positionRange.w * positionRange.w);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (distanceSq + 1.0);
+        float cone = smoothstep(colorOuter.w, directionInner.w, dot(-l, directionInner.xyz));
+        result += colorOuter.rgb * (max(dot(n, l), 0.0) * attenuation * cone);
+    }
+    return result;
+}
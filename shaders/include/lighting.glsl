@@ -0,0 +1,5 @@
+// Directional light plus flat ambient (Lambert)
+vec3 directionalLight(vec3 normal, vec3 lightDir, vec3 lightColor, vec3 ambientColor) {
+    float diff = max(dot(normalize(normal), normalize(-lightDir)), 0.0);
+    return ambientColor + diff * lightColor;
+}
@@ -0,0 +1,29 @@
+// Cascaded sun shadows (see lighting/shadows.hpp), filtered with PCF over
+// hardware depth comparisons
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 shadowMatrices[4];  // World to cascade texture coordinates and depth in [0, 1]
+uniform vec4 cascadeSplits;      // Far view depth of each cascade
+uniform vec4 cascadeTexelSizes;  // World units per shadow texel
+uniform int cascadeCount;        // 0: no shadows
+uniform int pcfRadius;
+uniform float normalBias;        // In texels
+
+// Fraction of the sun reaching worldPos, 1 beyond the last cascade
+float sunShadow(vec3 worldPos, vec3 normal, float viewDepth) {
+    int cascade = 0;
+    while (cascade < cascadeCount && viewDepth > cascadeSplits[cascade]) cascade++;
+    if (cascade >= cascadeCount) return 1.0;
+
+    // Pushing the receiver off its surface hides acne on surfaces at grazing angles
+    vec3 offset = normalize(normal) * (normalBias * cascadeTexelSizes[cascade]);
+    vec4 coord = shadowMatrices[cascade] * vec4(worldPos + offset, 1.0);
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int y = -pcfRadius; y <= pcfRadius; y++) {
+        for (int x = -pcfRadius; x <= pcfRadius; x++) {
+            lit += texture(shadowMap, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z));
+        }
+    }
+    float taps = float((2 * pcfRadius + 1) * (2 * pcfRadius + 1));
+    return lit / taps;
+}
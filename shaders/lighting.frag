@@ -0,0 +1,23 @@
+#version 330 core
+#include "include/lighting.glsl"
+#include "include/clusters.glsl"
+#ifdef SHADOWS
+#include "include/shadows.glsl"
+#endif
+out vec4 FragColor;
+in vec3 FragPos;
+in vec3 Normal;
+in vec4 ClipPos;
+uniform vec3 objectColor;
+uniform vec3 lightDir;
+uniform vec3 lightColor;
+uniform vec3 ambientColor;
+void main() {
+    vec3 sun = lightColor;
+#ifdef SHADOWS
+    sun *= sunShadow(FragPos, Normal, ClipPos.w);
+#endif
+    vec3 light = directionalLight(Normal, lightDir, sun, ambientColor) + clusteredLights(FragPos, Normal, ClipPos);
+    vec3 result = light * objectColor;
+    FragColor = vec4(result, 1.0);
+}
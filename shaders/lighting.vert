@@ -0,0 +1,18 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+out vec3 FragPos;
+out vec3 Normal;
+out vec4 ClipPos; // For the fragment's light cluster
+uniform mat4 model;
+uniform mat3 normalMatrix; // Inverse transpose of model's 3x3, from the CPU
+uniform mat4 view;
+uniform mat4 projection;
+invariant gl_Position; // Same expression as depth_only.vert for the pre-pass
+void main() {
+    vec4 world = model * vec4(aPos, 1.0);
+    FragPos = world.xyz;
+    Normal = normalMatrix * aNormal;
+    gl_Position = projection * (view * world);
+    ClipPos = gl_Position;
+}
@@ -2,6 +2,14 @@
 #define CAMERA_HPP
 
 #include <GLFW/glfw3.h>
+#include "../math/math.hpp"
+
+// Input sampled on the main thread (GLFW input is main-thread only) and applied
+// wherever the simulation runs.
+struct CameraInput {
+    bool forward = false, back = false, left = false, right = false;
+    float mouseDx = 0.0f, mouseDy = 0.0f; // Cursor motion accumulated since last apply
+};
 
 struct Camera {
     float pos[3] = {0.0f, 1.0f, 3.0f};
@@ -15,7 +23,13 @@ struct Camera {
 
     void processInput(GLFWwindow* window, float deltaTime);
     void mouseCallback(GLFWwindow* window, double xpos, double ypos);
-    void getViewMatrix(float* view) const;
+    static CameraInput readKeys(GLFWwindow* window);
+    void applyInput(const CameraInput& input, float deltaTime);
+    void rotate(float xoffset, float yoffset);
+    void updateFront();
+    // Render state between two simulated states; t = 0 gives a, t = 1 gives b
+    static Camera interpolate(const Camera& a, const Camera& b, float t);
+    mat4 getViewMatrix() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "ecs.hpp"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace {
+ComponentInfo componentInfos[MAX_COMPONENTS];
+uint32_t componentCount = 0;
+std::mutex registryMutex;
+
+size_t alignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+}
+
+uint32_t ComponentRegistry::registerType(const ComponentInfo& info) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (componentCount >= MAX_COMPONENTS) {
+        std::cerr << "ECS: more than " << MAX_COMPONENTS << " component types" << std::endl;
+        std::abort();
+    }
+    componentInfos[componentCount] = info;
+    return componentCount++;
+}
+
+const ComponentInfo& ComponentRegistry::info(uint32_t id) {
+    return componentInfos[id];
+}
+
+World::World() {
+    findOrCreateArchetype(0); // Entities without components
+}
+
+World::~World() {
+    clear();
+    for (Archetype* archetype : archetypes) {
+        delete archetype;
+    }
+}
+
+void World::clear() {
+    for (Archetype* archetype : archetypes) {
+        for (uint32_t row = 0; row < archetype->count; row++) {
+            for (uint32_t id : archetype->componentIds) {
+                ComponentRegistry::info(id).destroy(archetype->component(id, row));
+            }
+        }
+        archetype->count = 0;
+        for (Chunk* chunk : archetype->chunks) {
+            chunkPool.destroy(chunk);
+        }
+        archetype->chunks.clear();
+    }
+    for (size_t i = 0; i < records.size(); i++) {
+        if (records[i].archetype) {
+            records[i].archetype = nullptr;
+            records[i].generation++;
+            freeIndices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+Entity World::create() {
+    Entity entity;
+    if (!freeIndices.empty()) {
+        entity.index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        entity.index = static_cast<uint32_t>(records.size());
+        records.push_back({nullptr, 0, 0});
+    }
+    entity.generation = records[entity.index].generation;
+
+    Archetype* empty = archetypes[0];
+    records[entity.index].archetype = empty;
+    records[entity.index].row = allocateRow(empty, entity);
+    return entity;
+}
+
+void World::destroy(Entity entity) {
+    if (!alive(entity)) return;
+    EntityRecord& record = records[entity.index];
+    eraseRow(record.archetype, record.row, true);
+    record.archetype = nullptr;
+    record.generation++;
+    freeIndices.push_back(entity.index);
+}
+
+bool World::alive(Entity entity) const {
+    return entity.index < records.size() && records[entity.index].archetype &&
+           records[entity.index].generation == entity.generation;
+}
+
+Archetype* World::findOrCreateArchetype(ComponentMask mask) {
+    auto it = archetypeByMask.find(mask);
+    if (it != archetypeByMask.end()) return it->second;
+
+    Archetype* archetype = new Archetype();
+    archetype->mask = mask;
+    std::fill(std::begin(archetype->offsets), std::end(archetype->offsets), UINT32_MAX);
+    size_t rowBytes = sizeof(Entity);
+    for (uint32_t id = 0; id < MAX_COMPONENTS; id++) {
+        if (mask & (ComponentMask(1) << id)) {
+            archetype->componentIds.push_back(id);
+            rowBytes += ComponentRegistry::info(id).size;
+        }
+    }
+
+    // Largest row count whose cache-line-aligned arrays all fit in one chunk
+    uint32_t capacity = static_cast<uint32_t>(CHUNK_SIZE / rowBytes);
+    while (capacity > 0) {
+        size_t offset = alignUp(sizeof(Entity) * capacity, 64);
+        bool fits = true;
+        for (uint32_t id : archetype->componentIds) {
+            archetype->offsets[id] = static_cast<uint32_t>(offset);
+            offset = alignUp(offset + ComponentRegistry::info(id).size * capacity, 64);
+            if (offset > CHUNK_SIZE) {
+                fits = false;
+                break;
+            }
+        }
+        if (fits) break;
+        capacity--;
+    }
+    if (capacity == 0) {
+        std::cerr << "ECS: archetype row does not fit in a chunk" << std::endl;
+        std::abort();
+    }
+    archetype->capacity = capacity;
+
+    archetypes.push_back(archetype);
+    archetypeByMask[mask] = archetype;
+    return archetype;
+}
+
+uint32_t World::allocateRow(Archetype* archetype, Entity entity) {
+    uint32_t row = archetype->count++;
+    if (row / archetype->capacity >= archetype->chunks.size()) {
+        archetype->chunks.push_back(chunkPool.create());
+    }
+    archetype->entities(row / archetype->capacity)[row % archetype->capacity] = entity;
+    return row;
+}
+
+void World::eraseRow(Archetype* archetype, uint32_t row, bool destroyComponents) {
+    if (destroyComponents) {
+        for (uint32_t id : archetype->componentIds) {
+            ComponentRegistry::info(id).destroy(archetype->component(id, row));
+        }
+    }
+
+    // Move the last row into the hole to keep rows packed
+    uint32_t last = archetype->count - 1;
+    if (row != last) {
+        for (uint32_t id : archetype->componentIds) {
+            ComponentRegistry::info(id).moveConstruct(archetype->component(id, row), archetype->component(id, last));
+        }
+        Entity moved = archetype->entities(last / archetype->capacity)[last % archetype->capacity];
+        archetype->entities(row / archetype->capacity)[row % archetype->capacity] = moved;
+        records[moved.index].row = row;
+    }
+    archetype->count--;
+
+    // Release the trailing chunk once it is empty
+    if (archetype->count <= (archetype->chunks.size() - 1) * archetype->capacity) {
+        chunkPool.destroy(archetype->chunks.back());
+        archetype->chunks.pop_back();
+    }
+}
+
+void* World::addComponent(Entity entity, uint32_t id) {
+    EntityRecord& record = records[entity.index];
+    Archetype* from = record.archetype;
+    Archetype* to = findOrCreateArchetype(from->mask | (ComponentMask(1) << id));
+
+    uint32_t newRow = allocateRow(to, entity);
+    for (uint32_t other : from->componentIds) {
+        ComponentRegistry::info(other).moveConstruct(to->component(other, newRow), from->component(other, record.row));
+    }
+    eraseRow(from, record.row, false);
+    record.archetype = to;
+    record.row = newRow;
+    return to->component(id, newRow);
+}
+
+void World::removeComponent(Entity entity, uint32_t id) {
+    EntityRecord& record = records[entity.index];
+    Archetype* from = record.archetype;
+    Archetype* to = findOrCreateArchetype(from->mask & ~(ComponentMask(1) << id));
+
+    uint32_t newRow = allocateRow(to, entity);
+    for (uint32_t other : from->componentIds) {
+        void* src = from->component(other, record.row);
+        if (other == id) {
+            ComponentRegistry::info(other).destroy(src);
+        } else {
+            ComponentRegistry::info(other).moveConstruct(to->component(other, newRow), src);
+        }
+    }
+    eraseRow(from, record.row, false);
+    record.archetype = to;
+    record.row = newRow;
+}
+
+void World::collectChunks(ComponentMask mask) {
+    chunkScratch.clear();
+    size_t base = 0;
+    for (Archetype* archetype : archetypes) {
+        if ((archetype->mask & mask) != mask || archetype->count == 0) continue;
+        for (uint32_t c = 0; c < archetype->chunks.size(); c++) {
+            chunkScratch.push_back({archetype, c, base});
+            base += archetype->rowsInChunk(c);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../jobs/jobs.hpp"
+#include "../memory/pool.hpp"
+
+// Archetype-based entity-component system. Entities with the same set of
+// component types share an archetype, whose rows are stored in 16 KB chunks:
+// each chunk holds one cache-line-aligned array per component type, so a
+// query walks contiguous memory of exactly the components it asks for.
+//
+// Structural changes (create/destroy/add/remove) must not happen while a
+// query is iterating, and only from one thread at a time.
+
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+using ComponentMask = uint64_t;
+constexpr int MAX_COMPONENTS = 64;
+constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+struct ComponentInfo {
+    size_t size;
+    size_t align;
+    void (*moveConstruct)(void* dst, void* src); // Moves src into dst, then destroys src
+    void (*destroy)(void* ptr);
+};
+
+// Process-wide component type ids, assigned on first use of each type
+struct ComponentRegistry {
+    static uint32_t registerType(const ComponentInfo& info);
+    static const ComponentInfo& info(uint32_t id);
+};
+
+template <typename T>
+uint32_t componentId() {
+    static_assert(alignof(T) <= 64, "Component alignment above a cache line is not supported");
+    static const uint32_t id = ComponentRegistry::registerType({
+        sizeof(T), alignof(T),
+        [](void* dst, void* src) {
+            new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        },
+        [](void* ptr) { static_cast<T*>(ptr)->~T(); },
+    });
+    return id;
+}
+
+template <typename... Ts>
+ComponentMask componentMask() {
+    return (ComponentMask(0) | ... | (ComponentMask(1) << componentId<Ts>()));
+}
+
+struct alignas(64) Chunk {
+    unsigned char data[CHUNK_SIZE];
+};
+
+struct Archetype {
+    ComponentMask mask = 0;
+    uint32_t capacity = 0;                 // Rows per chunk
+    uint32_t count = 0;                    // Rows in use across all chunks
+    uint32_t offsets[MAX_COMPONENTS];      // Array offset in a chunk; UINT32_MAX if absent
+    std::vector<uint32_t> componentIds;
+    std::vector<Chunk*> chunks;
+
+    Entity* entities(uint32_t chunk) { return reinterpret_cast<Entity*>(chunks[chunk]->data); }
+    void* component(uint32_t id, uint32_t row) {
+        return chunks[row / capacity]->data + offsets[id] + (row % capacity) * ComponentRegistry::info(id).size;
+    }
+    template <typename T>
+    T* array(uint32_t chunk) {
+        return reinterpret_cast<T*>(chunks[chunk]->data + offsets[componentId<T>()]);
+    }
+    uint32_t rowsInChunk(uint32_t chunk) const {
+        uint32_t begin = chunk * capacity;
+        return count - begin < capacity ? count - begin : capacity;
+    }
+};
+
+struct World {
+    World();
+    ~World();
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    Entity create();
+    void destroy(Entity entity);
+    bool alive(Entity entity) const;
+    void clear();
+
+    template <typename T>
+    T& add(Entity entity, T value = T());
+    template <typename T>
+    void remove(Entity entity);
+    template <typename T>
+    T* get(Entity entity);
+    template <typename T>
+    bool has(Entity entity) const;
+
+    // f(Entity, Ts&...) for every entity that has all of Ts
+    template <typename... Ts, typename F>
+    void each(F&& f);
+    // f(size_t queryIndex, Entity, Ts&...) with one job per chunk. queryIndex
+    // is dense over the whole query (0..count<Ts...>()-1) for output arrays.
+    template <typename... Ts, typename F>
+    void parallelEach(JobSystem* jobs, F&& f);
+    template <typename... Ts>
+    size_t count();
+
+private:
+    struct EntityRecord {
+        Archetype* archetype;
+        uint32_t row;
+        uint32_t generation;
+    };
+    struct ChunkRef {
+        Archetype* archetype;
+        uint32_t chunk;
+        size_t base; // Query index of the chunk's first row
+    };
+
+    std::vector<Archetype*> archetypes;
+    std::unordered_map<ComponentMask, Archetype*> archetypeByMask;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    std::vector<ChunkRef> chunkScratch; // Reused by parallelEach
+    Pool<Chunk, 16> chunkPool;          // Entity churn recycles chunks instead of hitting the heap
+
+    Archetype* findOrCreateArchetype(ComponentMask mask);
+    uint32_t allocateRow(Archetype* archetype, Entity entity);
+    void eraseRow(Archetype* archetype, uint32_t row, bool destroyComponents);
+    void* addComponent(Entity entity, uint32_t id);   // Returns uninitialized storage
+    void removeComponent(Entity entity, uint32_t id);
+    void collectChunks(ComponentMask mask);
+};
+
+template <typename T>
+T& World::add(Entity entity, T value) {
+    if (T* existing = get<T>(entity)) {
+        *existing = std::move(value);
+        return *existing;
+    }
+    void* storage = addComponent(entity, componentId<T>());
+    return *new (storage) T(std::move(value));
+}
+
+template <typename T>
+void World::remove(Entity entity) {
+    if (has<T>(entity)) removeComponent(entity, componentId<T>());
+}
+
+template <typename T>
+T* World::get(Entity entity) {
+    if (!alive(entity)) return nullptr;
+    const EntityRecord& record = records[entity.index];
+    uint32_t id = componentId<T>();
+    if (!(record.archetype->mask & (ComponentMask(1) << id))) return nullptr;
+    return static_cast<T*>(record.archetype->component(id, record.row));
+}
+
+template <typename T>
+bool World::has(Entity entity) const {
+    return alive(entity) && (records[entity.index].archetype->mask & (ComponentMask(1) << componentId<T>()));
+}
+
+template <typename... Ts, typename F>
+void World::each(F&& f) {
+    ComponentMask mask = componentMask<Ts...>();
+    for (Archetype* archetype : archetypes) {
+        if ((archetype->mask & mask) != mask || archetype->count == 0) continue;
+        for (uint32_t c = 0; c < archetype->chunks.size(); c++) {
+            uint32_t rows = archetype->rowsInChunk(c);
+            Entity* entities = archetype->entities(c);
+            auto arrays = std::make_tuple(archetype->array<Ts>(c)...);
+            for (uint32_t i = 0; i < rows; i++) {
+                std::apply([&](Ts*... columns) { f(entities[i], columns[i]...); }, arrays);
+            }
+        }
+    }
+}
+
+template <typename... Ts, typename F>
+void World::parallelEach(JobSystem* jobs, F&& f) {
+    collectChunks(componentMask<Ts...>());
+    const ChunkRef* refs = chunkScratch.data();
+    auto run = [refs, &f](unsigned int begin, unsigned int end) {
+        for (unsigned int k = begin; k < end; k++) {
+            Archetype* archetype = refs[k].archetype;
+            uint32_t c = refs[k].chunk;
+            uint32_t rows = archetype->rowsInChunk(c);
+            Entity* entities = archetype->entities(c);
+            auto arrays = std::make_tuple(archetype->array<Ts>(c)...);
+            for (uint32_t i = 0; i < rows; i++) {
+                std::apply([&](Ts*... columns) { f(refs[k].base + i, entities[i], columns[i]...); }, arrays);
+            }
+        }
+    };
+    unsigned int chunkCount = static_cast<unsigned int>(chunkScratch.size());
+    if (jobs) {
+        jobs->parallelFor(chunkCount, 1, run);
+    } else {
+        run(0, chunkCount);
+    }
+}
+
+template <typename... Ts>
+size_t World::count() {
+    ComponentMask mask = componentMask<Ts...>();
+    size_t total = 0;
+    for (Archetype* archetype : archetypes) {
+        if ((archetype->mask & mask) == mask) total += archetype->count;
+    }
+    return total;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#include "fixed_timestep.hpp"
+#include <cmath>
+
+int FixedTimestep::advance(double frameTime) {
+    if (frameTime < 0.0) frameTime = 0.0;
+    if (frameTime > maxFrameTime) frameTime = maxFrameTime;
+    accumulator += frameTime;
+
+    int steps = 0;
+    while (accumulator >= step && steps < maxStepsPerFrame) {
+        accumulator -= step;
+        steps++;
+    }
+    if (accumulator >= step) {
+        // Falling behind: simulate slower than real time rather than spiral
+        accumulator = std::fmod(accumulator, step);
+    }
+    tick += steps;
+    return steps;
+}
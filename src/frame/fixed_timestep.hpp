@@ -0,0 +1,25 @@
+#ifndef FIXED_TIMESTEP_HPP
+#define FIXED_TIMESTEP_HPP
+
+#include <cstdint>
+
+// Accumulator-based fixed-step simulation clock. Variable frame times are
+// banked and consumed in whole steps so simulation never depends on frame
+// rate; the leftover fraction is used to interpolate render state.
+struct FixedTimestep {
+    double step = 1.0 / 120.0;   // Seconds per simulation tick
+    int maxStepsPerFrame = 8;    // Spiral-of-death guard
+    double maxFrameTime = 0.25;  // Ignore hitches longer than this (debugger, window drag)
+
+    double accumulator = 0.0;
+    uint64_t tick = 0;           // Total simulated steps
+
+    // Banks frameTime and returns how many steps to simulate now. If more than
+    // maxStepsPerFrame are due, the backlog is dropped instead of carried over.
+    int advance(double frameTime);
+
+    // Fraction of a step between the last two simulated states, in [0, 1)
+    float alpha() const { return static_cast<float>(accumulator / step); }
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "frame_pipeline.hpp"
+#include "../memory/alloc_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+struct DrawSortKey {
+    float distance;
+    uint32_t index;
+};
+
+} // namespace
+
+bool FramePipeline::start(Scene& sceneRef, JobSystem* jobSystem, int latencyFrames) {
+    scene = &sceneRef;
+    camera = nullptr;
+    scene->world.each<CameraComponent>([this](Entity entity, CameraComponent& component) {
+        if (!camera && component.camera) {
+            cameraEntity = entity;
+            camera = component.camera;
+        }
+    });
+    if (!camera) {
+        std::cerr << "FramePipeline: no entity with a CameraComponent" << std::endl;
+        return false;
+    }
+    jobs = jobSystem;
+    for (RenderPacket& packet : packets) {
+        packet.arena.init(256 * 1024);
+    }
+    latency = latencyFrames > 0 ? 1 : 0;
+    previousCamera = *camera;
+
+    // Prime the first packet so frame 0 has something to render
+    update(packets[0], CameraInput(), shadowSettings, 0.0f);
+    renderIndex = 0;
+
+    if (latency > 0) {
+        quit = false;
+        thread = std::thread(&FramePipeline::threadLoop, this);
+    }
+    return true;
+}
+
+void FramePipeline::stop() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void FramePipeline::printArenaStats() const {
+    ::printArenaStats("packet 0", packets[0].arena);
+    ::printArenaStats("packet 1", packets[1].arena);
+}
+
+void FramePipeline::sync() {
+    if (latency > 0) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return !hasWork; });
+        if (submitted) {
+            renderIndex = workIndex;
+            submitted = false;
+        }
+    }
+
+    // The update thread is idle until kick(). GL names retired by the removals
+    // are still in the packet rendered this frame, so they are deleted
+    // latency + 1 syncs later, once no packet built before the removal is left.
+    scene->meshes.collectRetired(latency + 1);
+    scene->applyRemovals();
+}
+
+void FramePipeline::kick(GLFWwindow* window, double frameTime) {
+    CameraInput input = Camera::readKeys(window);
+    input.mouseDx = pendingInput.mouseDx;
+    input.mouseDy = pendingInput.mouseDy;
+    pendingInput = CameraInput();
+
+    if (latency == 0) {
+        update(packets[0], input, shadowSettings, frameTime);
+        renderIndex = 0;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        workIndex = 1 - renderIndex; // The packet not being rendered this frame
+        workInput = input;
+        workShadows = shadowSettings;
+        workFrameTime = frameTime;
+        hasWork = true;
+        submitted = true;
+    }
+    wake.notify_one();
+}
+
+void FramePipeline::onMouse(double xpos, double ypos) {
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+    pendingInput.mouseDx += static_cast<float>(xpos - lastX);
+    pendingInput.mouseDy += static_cast<float>(lastY - ypos);
+    lastX = xpos;
+    lastY = ypos;
+}
+
+void FramePipeline::threadLoop() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]() { return hasWork || quit; });
+        if (quit) break;
+        int index = workIndex;
+        CameraInput input = workInput;
+        ShadowSettings cascadeSettings = workShadows;
+        double frameTime = workFrameTime;
+        lock.unlock();
+
+        {
+            // The main thread's guard does not reach this thread
+            AllocFrameGuard allocGuard(frameCounter >= allocGuardWarmup, AllocGuardMode::Log);
+            update(packets[index], input, cascadeSettings, frameTime);
+        }
+
+        lock.lock();
+        hasWork = false;
+        lock.unlock();
+        done.notify_one();
+    }
+}
+
+void FramePipeline::update(RenderPacket& packet, const CameraInput& input, const ShadowSettings& cascadeSettings,
+                           double frameTime) {
+    // Mouse look is applied to both states right away so it never lags a step
+    if (input.mouseDx != 0.0f || input.mouseDy != 0.0f) {
+        camera->rotate(input.mouseDx, input.mouseDy);
+        previousCamera.yaw = camera->yaw;
+        previousCamera.pitch = camera->pitch;
+        previousCamera.updateFront();
+    }
+
+    CameraInput keys = input;
+    keys.mouseDx = keys.mouseDy = 0.0f;
+    int steps = clock.advance(frameTime);
+    float step = static_cast<float>(clock.step);
+    for (int i = 0; i < steps; i++) {
+        previousCamera = *camera;
+        camera->applyInput(keys, step);
+    }
+
+    Camera view = Camera::interpolate(previousCamera, *camera, clock.alpha());
+    packet.view = view.getViewMatrix();
+    for (int i = 0; i < 3; i++) packet.cameraPos[i] = view.pos[i];
+    packet.frame = frameCounter++;
+    packet.simTick = clock.tick;
+    packet.alpha = clock.alpha();
+
+    const CameraComponent* lens = scene->world.get<CameraComponent>(cameraEntity);
+    packet.projection = perspective(lens->fovY, lens->aspect, lens->zNear, lens->zFar);
+
+    packet.sun = LightComponent();
+    bool foundSun = false;
+    scene->world.each<LightComponent>([&](Entity, const LightComponent& light) {
+        if (!foundSun && light.type == LightType::Directional) {
+            packet.sun = light;
+            foundSun = true;
+        }
+    });
+    if (!foundSun) packet.sun.intensity = 0.0f; // Ambient only
+
+    scene->transforms.updateWorldMatrices(jobs);
+
+    packet.shadows.count = 0;
+    if (foundSun) {
+        fitCascades(cascadeSettings, packet.view, lens->fovY, lens->aspect, lens->zNear, lens->zFar, packet.sun.direction,
+                    packet.shadows);
+    }
+
+    // One job per chunk of mesh entities; queryIndex packs the draws densely.
+    // Each object's LOD follows its bounding sphere's projected size, and the
+    // same sphere decides which shadow cascades it is drawn into.
+    World& world = scene->world;
+    packet.arena.reset();
+    packet.drawCount = world.count<Object, TransformComponent>();
+    packet.draws = packet.arena.allocateArray<DrawItem>(packet.drawCount);
+    DrawItem* draws = packet.draws;
+    const TransformStore* transforms = &scene->transforms;
+    const LodSettings* lodSettings = &this->lodSettings;
+    vec3 eye = {packet.cameraPos[0], packet.cameraPos[1], packet.cameraPos[2]};
+    float tanHalfFov = std::tan(lens->fovY * 0.5f);
+    const ShadowCascades* shadows = &packet.shadows;
+    float* distances = packet.arena.allocateArray<float>(packet.drawCount);
+
+    world.parallelEach<Object, TransformComponent>(jobs,
+        [draws, distances, transforms, lodSettings, eye, tanHalfFov, shadows](size_t i, Entity, Object& obj,
+                                                                             const TransformComponent& transform) {
+            uint32_t slot = transforms->slot(transform.handle);
+            vec3 center = {transforms->worldCenterX[slot], transforms->worldCenterY[slot], transforms->worldCenterZ[slot]};
+            float distance = length(center - eye);
+            float screenSize = transforms->worldRadius[slot] / std::fmax(distance * tanHalfFov, 1e-4f);
+            obj.lod = static_cast<uint8_t>(selectLod(obj.lod, obj.lodCount, screenSize, *lodSettings));
+
+            distances[i] = distance;
+            DrawItem& draw = draws[i];
+            draw.VAO = obj.VAO;
+            draw.depthVAO = obj.depthVAO;
+            draw.indexOffset = obj.lods[obj.lod].indexOffset;
+            draw.indexCount = obj.lods[obj.lod].indexCount;
+            draw.model = transforms->world[slot];
+            draw.normal = transforms->worldNormal[slot];
+            draw.cascadeMask = cascadeMask(*shadows, center, transforms->worldRadius[slot]);
+        });
+
+    // Nearest first, so early depth testing rejects most hidden fragments;
+    // keys are sorted and the draws gathered into a second arena array
+    if (sortFrontToBack && packet.drawCount > 1) {
+        DrawSortKey* keys = packet.arena.allocateArray<DrawSortKey>(packet.drawCount);
+        for (size_t i = 0; i < packet.drawCount; i++) keys[i] = {distances[i], static_cast<uint32_t>(i)};
+        std::sort(keys, keys + packet.drawCount,
+                  [](const DrawSortKey& a, const DrawSortKey& b) { return a.distance < b.distance; });
+        DrawItem* sorted = packet.arena.allocateArray<DrawItem>(packet.drawCount);
+        for (size_t i = 0; i < packet.drawCount; i++) sorted[i] = draws[keys[i].index];
+        packet.draws = sorted;
+    }
+
+    // Terrain chunks by distance band, culled against this packet's frustum
+    packet.terrainChunkCount = 0;
+    if (scene->terrain) {
+        Frustum frustum = frustumFromMatrix(packet.projection * packet.view);
+        size_t capacity = static_cast<size_t>(scene->terrain->settings.maxChunks);
+        packet.terrainChunks = packet.arena.allocateArray<TerrainChunk>(capacity);
+        packet.terrainChunkCount = scene->terrain->select(eye, frustum, packet.terrainChunks, capacity);
+    }
+
+    // Point and spot lights take their position from the entity's transform
+    uint32_t lightCapacity = static_cast<uint32_t>(std::min<size_t>(world.count<LightComponent, TransformComponent>(),
+                                                                    clusterSettings.maxLights));
+    GpuLight* lights = packet.arena.allocateArray<GpuLight>(lightCapacity);
+    uint32_t lightCount = 0;
+    world.each<LightComponent, TransformComponent>([&](Entity, const LightComponent& light, const TransformComponent& transform) {
+        if (light.type == LightType::Directional || lightCount == lightCapacity) return;
+        const mat4& model = transforms->worldMatrix(transform.handle);
+        lights[lightCount++] = packLight(light, {model.m[12], model.m[13], model.m[14]});
+    });
+    assignClusters(clusterSettings, packet.view, packet.projection, lens->zNear, lens->zFar, lights, lightCount,
+                   packet.arena, jobs, packet.lights);
+}
@@ -0,0 +1,115 @@
+#ifndef FRAME_PIPELINE_HPP
+#define FRAME_PIPELINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../camera/camera.hpp"
+#include "fixed_timestep.hpp"
+#include "../jobs/jobs.hpp"
+#include "../lighting/clusters.hpp"
+#include "../lighting/shadows.hpp"
+#include "../memory/arena.hpp"
+#include "../scene/scene.hpp"
+#include "../terrain/terrain.hpp"
+
+struct DrawItem {
+    mat4 model;
+    mat3 normal; // Inverse transpose of model's 3x3
+    unsigned int VAO;
+    unsigned int depthVAO; // Positions only, same indices
+    int indexOffset; // Into the mesh's EBO, in indices
+    int indexCount;
+    uint8_t cascadeMask; // Shadow cascades the object may cast into
+};
+
+// Everything the render thread needs for one frame; it never reads Camera or
+// Scene::world directly. Per-frame lists come from the packet's arena, which
+// is reset each time the packet is rebuilt.
+struct RenderPacket {
+    Arena arena;
+    uint64_t frame = 0;
+    uint64_t simTick = 0;  // Last simulated fixed step
+    float alpha = 0.0f;    // Interpolation between simTick - 1 and simTick
+    mat4 view;
+    mat4 projection;
+    float cameraPos[3];
+    LightComponent sun;    // First directional light in the world
+    DrawItem* draws = nullptr;
+    size_t drawCount = 0;
+    TerrainChunk* terrainChunks = nullptr; // Visible chunks when Scene::terrain is set
+    size_t terrainChunkCount = 0;
+    ClusterLights lights;  // Point and spot lights binned into view froxels
+    ShadowCascades shadows; // Sun cascades; count 0 without a sun
+};
+
+// Runs camera/scene update on its own thread one frame ahead of the render
+// thread, double-buffering RenderPackets. Per frame on the main thread:
+//
+//   pipeline.sync();               // Wait for frame N's packet; apply Scene::remove()
+//   scene.processUploads(...);     // Scene may only be mutated here
+//   pipeline.kick(window, dt);     // Start building frame N+1
+//   renderer.render(scene, pipeline.current());
+//
+// With latency 0 kick() updates inline and current() is this frame's packet.
+//
+// Simulation advances in fixed steps of clock.step; the packet's view is
+// interpolated between the last two simulated camera states. The camera is the
+// first entity with a CameraComponent when start() is called.
+struct FramePipeline {
+    FixedTimestep clock; // Configure before start()
+    LodSettings lodSettings;
+    ClusterSettings clusterSettings;
+    ShadowSettings shadowSettings; // Main thread; may change between frames, copied by kick()
+    bool sortFrontToBack = true;   // Order draws nearest first for early depth rejection
+    // With CISCO_TRACK_ALLOCATIONS, updates after this many frames run under
+    // an AllocFrameGuard on the update thread; set before start()
+    uint64_t allocGuardWarmup = UINT64_MAX;
+
+    bool start(Scene& scene, JobSystem* jobs, int latencyFrames = 1);
+    void stop();
+
+    void sync();
+    void kick(GLFWwindow* window, double frameTime);
+    void printArenaStats() const; // Packet arenas' peak and growths; after stop() or sync()
+    const RenderPacket& current() const { return packets[renderIndex]; }
+
+    // Main thread cursor callback; motion is accumulated until the next kick()
+    void onMouse(double xpos, double ypos);
+
+private:
+    Scene* scene = nullptr;
+    Entity cameraEntity;
+    Camera* camera = nullptr;
+    Camera previousCamera;     // Camera state one fixed step before *camera
+    JobSystem* jobs = nullptr;
+    int latency = 1;
+
+    RenderPacket packets[2];
+    int renderIndex = 0;
+
+    CameraInput pendingInput; // Main thread only
+    double lastX = 0.0, lastY = 0.0;
+    bool firstMouse = true;
+
+    // Handoff to the update thread
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake; // Main -> update thread: work available
+    std::condition_variable done; // Update thread -> main: packet finished
+    bool hasWork = false;
+    bool submitted = false;       // A kick() that sync() has not collected yet
+    bool quit = false;
+    CameraInput workInput;
+    ShadowSettings workShadows;
+    double workFrameTime = 0.0;
+    int workIndex = 1;
+    uint64_t frameCounter = 0;
+
+    void threadLoop();
+    void update(RenderPacket& packet, const CameraInput& input, const ShadowSettings& cascadeSettings, double frameTime);
+};
+
+#endif
@@ -0,0 +1,210 @@
+#include "jobs.hpp"
+#include <cstring>
+#include <iostream>
+
+namespace {
+// Slot of the calling thread in JobSystem::threads, -1 if not registered.
+thread_local int currentThread = -1;
+}
+
+void JobDeque::store(int64_t index, const Job& job) {
+    uint64_t words[WORDS];
+    std::memcpy(words, &job, sizeof(Job));
+    for (int i = 0; i < WORDS; i++) {
+        storage[index & (CAPACITY - 1)][i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+void JobDeque::load(int64_t index, Job& out) const {
+    uint64_t words[WORDS];
+    for (int i = 0; i < WORDS; i++) {
+        words[i] = storage[index & (CAPACITY - 1)][i].load(std::memory_order_relaxed);
+    }
+    std::memcpy(&out, words, sizeof(Job));
+}
+
+bool JobDeque::push(const Job& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) {
+        return false; // Full; caller runs the job inline
+    }
+    store(b, job);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+bool JobDeque::pop(Job& out) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed); // Empty
+        return false;
+    }
+
+    load(b, out);
+    if (t == b) {
+        // Last element: race against thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+bool JobDeque::steal(Job& out) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+
+    // Copy before claiming: the owner may reuse the slot as soon as top moves.
+    // If the copy raced with such a reuse, the CAS below fails and it is dropped.
+    load(t, out);
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+void JobSystem::init(int numWorkers) {
+    if (numWorkers < 0) {
+        unsigned int hw = std::thread::hardware_concurrency();
+        numWorkers = hw > 1 ? static_cast<int>(hw) - 1 : 0;
+    }
+    if (numWorkers > 64) numWorkers = 64;
+
+    quit = false;
+    numThreads = static_cast<unsigned int>(numWorkers) + 1;
+    for (unsigned int i = 0; i < numThreads; i++) {
+        threads[i].store(new ThreadState(), std::memory_order_relaxed);
+    }
+    registeredThreads.store(numThreads, std::memory_order_release);
+
+    currentThread = 0; // Calling thread participates as slot 0
+    for (unsigned int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        quit = true;
+    }
+    sleepCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    for (auto& state : threads) {
+        delete state.exchange(nullptr);
+    }
+    registeredThreads = 0;
+    numThreads = 0;
+    currentThread = -1;
+}
+
+void JobSystem::registerThread() {
+    if (currentThread >= 0) return;
+
+    unsigned int index = registeredThreads.load(std::memory_order_relaxed);
+    while (true) {
+        if (index >= MAX_THREADS) {
+            std::cerr << "JobSystem: too many registered threads" << std::endl;
+            return;
+        }
+        // Reserve the slot first so concurrent registrations don't collide
+        if (registeredThreads.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+    // Thieves skip null slots until the state is published
+    threads[index].store(new ThreadState(), std::memory_order_release);
+    currentThread = static_cast<int>(index);
+}
+
+void JobSystem::submit(const Job& job) {
+    if (currentThread < 0) registerThread();
+    if (job.counter) {
+        job.counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (currentThread < 0 || !threads[currentThread].load(std::memory_order_relaxed)->deque.push(job)) {
+        Job inlineJob = job;
+        execute(inlineJob);
+        return;
+    }
+
+    pendingJobs.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        sleepCondition.notify_one();
+    }
+}
+
+void JobSystem::execute(Job& job) {
+    JobCounter* counter = job.counter;
+    job.function(job);
+    if (counter) {
+        counter->value.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+bool JobSystem::runOne() {
+    Job job;
+    bool found = threads[currentThread].load(std::memory_order_relaxed)->deque.pop(job);
+
+    if (!found) {
+        unsigned int count = registeredThreads.load(std::memory_order_acquire);
+        // Start stealing from a neighbour so thieves spread out
+        for (unsigned int i = 1; i < count && !found; i++) {
+            unsigned int victim = (currentThread + i) % count;
+            ThreadState* state = threads[victim].load(std::memory_order_acquire);
+            if (state) found = state->deque.steal(job);
+        }
+    }
+
+    if (!found) return false;
+    pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+    execute(job);
+    return true;
+}
+
+void JobSystem::wait(JobCounter* counter) {
+    if (currentThread < 0) registerThread();
+    while (counter->value.load(std::memory_order_acquire) > 0) {
+        if (currentThread < 0 || !runOne()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned int index) {
+    currentThread = static_cast<int>(index);
+    int idleSpins = 0;
+
+    while (!quit.load(std::memory_order_relaxed)) {
+        if (runOne()) {
+            idleSpins = 0;
+            continue;
+        }
+        if (++idleSpins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [this]() {
+                return quit.load() || pendingJobs.load(std::memory_order_seq_cst) > 0;
+            });
+        }
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        idleSpins = 0;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Outstanding-work counter. A job spawned with a counter increments it and
+// decrements it when it finishes; wait() on the counter is the dependency.
+struct JobCounter {
+    std::atomic<int> value{0};
+};
+
+// One cache line: function + counter + inline payload for a small closure.
+struct alignas(64) Job {
+    void (*function)(Job& job);
+    JobCounter* counter;
+    alignas(16) unsigned char payload[48];
+};
+
+// Fixed-capacity Chase-Lev work-stealing deque (Le et al. 2013 memory orders).
+// Only the owning thread may push/pop; any thread may steal. Jobs live in the
+// deque's own storage at their queue index, so a slot is only rewritten once
+// the job in it has been taken; pop/steal return a copy. Slots are stored as
+// relaxed atomic words because thieves read speculatively before their CAS.
+struct JobDeque {
+    static constexpr int64_t CAPACITY = 4096; // Power of two
+
+    bool push(const Job& job);
+    bool pop(Job& out);
+    bool steal(Job& out);
+
+private:
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    static constexpr int WORDS = sizeof(Job) / sizeof(uint64_t);
+    std::atomic<uint64_t> storage[CAPACITY][WORDS];
+
+    void store(int64_t index, const Job& job);
+    void load(int64_t index, Job& out) const;
+};
+
+struct JobSystem {
+    static constexpr int MAX_THREADS = 64 + 4; // Workers + main + registered threads
+
+    // numWorkers < 0 uses hardware_concurrency() - 1; 0 runs everything on the
+    // calling thread. The calling thread becomes slot 0 and runs jobs while it waits.
+    void init(int numWorkers = -1);
+    void shutdown();
+
+    // Gives a non-worker thread (loader, update thread) its own deque so it can
+    // spawn jobs and help while waiting. Call once from that thread.
+    void registerThread();
+
+    // Spawns a trivially copyable closure (<= 48 bytes) as a job.
+    template <typename F>
+    void run(JobCounter* counter, F func);
+
+    // Runs func(begin, end) over [0, count) in batches and waits for completion.
+    template <typename F>
+    void parallelFor(unsigned int count, unsigned int batchSize, F func);
+
+    // Executes other jobs until counter reaches zero.
+    void wait(JobCounter* counter);
+
+    unsigned int threadCount() const { return numThreads; }
+
+private:
+    struct ThreadState {
+        JobDeque deque;
+    };
+
+    std::atomic<ThreadState*> threads[MAX_THREADS] = {};
+    std::vector<std::thread> workers;
+    unsigned int numThreads = 0;
+    std::atomic<unsigned int> registeredThreads{0};
+    std::atomic<bool> quit{false};
+
+    // Sleeping workers are woken only when there is someone to wake.
+    std::atomic<int> pendingJobs{0};
+    std::atomic<int> sleepingWorkers{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    void submit(const Job& job);
+    bool runOne();
+    void execute(Job& job);
+    void workerLoop(unsigned int index);
+};
+
+template <typename F>
+void JobSystem::run(JobCounter* counter, F func) {
+    static_assert(std::is_trivially_copyable<F>::value, "Job closures must be trivially copyable");
+    static_assert(sizeof(F) <= sizeof(Job::payload), "Job closure too large; capture a pointer instead");
+
+    Job job;
+    job.counter = counter;
+    new (job.payload) F(func);
+    job.function = [](Job& j) { (*reinterpret_cast<F*>(j.payload))(); };
+    submit(job);
+}
+
+template <typename F>
+void JobSystem::parallelFor(unsigned int count, unsigned int batchSize, F func) {
+    if (count == 0) return;
+    if (batchSize == 0) batchSize = 1;
+    if (count <= batchSize) {
+        func(0u, count);
+        return;
+    }
+
+    JobCounter counter;
+    const F* shared = &func;
+    for (unsigned int begin = 0; begin < count; begin += batchSize) {
+        unsigned int end = begin + batchSize < count ? begin + batchSize : count;
+        run(&counter, [shared, begin, end]() { (*shared)(begin, end); });
+    }
+    wait(&counter);
+}
+
+#endif
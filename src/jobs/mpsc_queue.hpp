@@ -0,0 +1,55 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+
+// Lock-free intrusive multi-producer single-consumer queue (Vyukov).
+// T must be default constructible and have a `std::atomic<T*> next` member.
+// Any thread may push; only one thread may pop. Nodes are owned by the caller.
+template <typename T>
+struct MpscQueue {
+    MpscQueue() : head(&stub), tail(&stub) {
+        stub.next.store(nullptr, std::memory_order_relaxed);
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        T* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Returns nullptr when empty (or when a producer is mid-push).
+    T* pop() {
+        T* t = tail;
+        T* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return t;
+        }
+        if (t != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        push(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+private:
+    std::atomic<T*> head;
+    T* tail; // Consumer only
+    T stub;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "clusters.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// A light's bounding sphere in view space; depth is positive in front
+struct LightBounds {
+    float x, y, depth, radius;
+    int firstSlice, lastSlice; // Empty when firstSlice > lastSlice
+};
+
+struct ClusterGrid {
+    int tilesX, tilesY, slices;
+    float zNear;
+    float sliceScale; // slices / log(zFar / zNear)
+    float xScale, yScale; // Projection terms: ndc = scale * view / depth
+
+    float sliceStart(int slice) const { return zNear * std::exp(slice / sliceScale); }
+    int sliceOf(float depth) const { return static_cast<int>(std::floor(std::log(depth / zNear) * sliceScale)); }
+};
+
+// Tile range (inclusive) covered by a light within one slice's depth band;
+// false if the sphere misses the band or the screen
+bool sliceRect(const ClusterGrid& grid, const LightBounds& light, float bandNear, float bandFar, int rect[4]) {
+    // The widest cross-section inside the band bounds the sphere's x/y extent there
+    float nearest = std::clamp(light.depth, bandNear, bandFar) - light.depth;
+    float radiusSq = light.radius * light.radius - nearest * nearest;
+    if (radiusSq <= 0.0f) return false;
+    float r = std::sqrt(radiusSq);
+    float d0 = std::max(light.depth - light.radius, bandNear);
+    float d1 = std::min(light.depth + light.radius, bandFar);
+
+    // Extremes of x / depth over the box [x - r, x + r] x [d0, d1]
+    float lo[2] = {light.x - r, light.y - r};
+    float hi[2] = {light.x + r, light.y + r};
+    float scale[2] = {grid.xScale, grid.yScale};
+    int tiles[2] = {grid.tilesX, grid.tilesY};
+    for (int axis = 0; axis < 2; axis++) {
+        float ndcLo = scale[axis] * lo[axis] / (lo[axis] < 0.0f ? d0 : d1);
+        float ndcHi = scale[axis] * hi[axis] / (hi[axis] > 0.0f ? d0 : d1);
+        int first = static_cast<int>(std::floor((ndcLo * 0.5f + 0.5f) * tiles[axis]));
+        int last = static_cast<int>(std::floor((ndcHi * 0.5f + 0.5f) * tiles[axis]));
+        if (last < 0 || first >= tiles[axis]) return false;
+        rect[axis * 2] = std::max(first, 0);
+        rect[axis * 2 + 1] = std::min(last, tiles[axis] - 1);
+    }
+    return true;
+}
+
+// Counts (fill = false) or writes (fill = true) one slice's light lists.
+// Writing uses ranges[2c + 1] as the cursor, so counts must be zeroed first.
+void processSlice(const ClusterGrid& grid, const LightBounds* bounds, uint32_t lightCount, int slice, bool fill,
+                  uint32_t* ranges, uint16_t* indices) {
+    float bandNear = grid.sliceStart(slice);
+    float bandFar = grid.sliceStart(slice + 1);
+    int rect[4];
+    for (uint32_t i = 0; i < lightCount; i++) {
+        const LightBounds& light = bounds[i];
+        if (slice < light.firstSlice || slice > light.lastSlice) continue;
+        if (!sliceRect(grid, light, bandNear, bandFar, rect)) continue;
+        for (int y = rect[2]; y <= rect[3]; y++) {
+            uint32_t row = static_cast<uint32_t>((slice * grid.tilesY + y) * grid.tilesX);
+            for (int x = rect[0]; x <= rect[1]; x++) {
+                uint32_t* range = ranges + (row + x) * 2;
+                if (fill) indices[range[0] + range[1]] = static_cast<uint16_t>(i);
+                range[1]++;
+            }
+        }
+    }
+}
+
+} // namespace
+
+GpuLight packLight(const LightComponent& light, vec3 position) {
+    GpuLight packed;
+    vec3 color = light.color * light.intensity;
+    vec3 direction = normalize(light.direction);
+    bool spot = light.type == LightType::Spot;
+    for (int i = 0; i < 3; i++) {
+        packed.position[i] = (&position.x)[i];
+        packed.color[i] = (&color.x)[i];
+        packed.direction[i] = (&direction.x)[i];
+    }
+    packed.range = light.range;
+    packed.cosOuter = spot ? light.outerCone : -2.0f;
+    packed.cosInner = spot ? light.innerCone : -1.0f;
+    return packed;
+}
+
+void assignClusters(const ClusterSettings& settings, const mat4& view, const mat4& projection, float zNear, float zFar,
+                    const GpuLight* lights, uint32_t lightCount, Arena& arena, JobSystem* jobs, ClusterLights& out) {
+    ClusterGrid grid;
+    grid.tilesX = settings.tilesX;
+    grid.tilesY = settings.tilesY;
+    grid.slices = settings.slices;
+    grid.zNear = zNear;
+    float farDepth = std::max(std::min(zFar, settings.maxDistance), zNear * 2.0f);
+    grid.sliceScale = grid.slices / std::log(farDepth / zNear);
+    grid.xScale = projection.m[0];
+    grid.yScale = projection.m[5];
+
+    out.lights = lights;
+    out.lightCount = lightCount;
+    out.tilesX = grid.tilesX;
+    out.tilesY = grid.tilesY;
+    out.slices = grid.slices;
+    out.zNear = zNear;
+    out.zFar = farDepth;
+
+    uint32_t clusterCount = out.clusterCount();
+    out.ranges = arena.allocateArray<uint32_t>(clusterCount * 2);
+    std::fill(out.ranges, out.ranges + clusterCount * 2, 0u);
+
+    // View-space bounding spheres; a spot's cone is bounded more tightly than
+    // by its range sphere
+    LightBounds* bounds = arena.allocateArray<LightBounds>(lightCount);
+    for (uint32_t i = 0; i < lightCount; i++) {
+        const GpuLight& light = lights[i];
+        vec3 center = {light.position[0], light.position[1], light.position[2]};
+        float radius = light.range;
+        if (light.cosOuter > -1.0f) {
+            vec3 axis = {light.direction[0], light.direction[1], light.direction[2]};
+            float cosAngle = std::max(light.cosOuter, 1e-3f);
+            if (cosAngle < 0.70710678f) {
+                center = center + axis * (light.range * cosAngle);
+                radius = light.range * std::sqrt(std::max(1.0f - cosAngle * cosAngle, 0.0f));
+            } else {
+                radius = light.range / (2.0f * cosAngle);
+                center = center + axis * radius;
+            }
+        }
+        vec4 viewCenter = view * vec4{center.x, center.y, center.z, 1.0f};
+
+        LightBounds& b = bounds[i];
+        b.x = viewCenter.x;
+        b.y = viewCenter.y;
+        b.depth = -viewCenter.z;
+        b.radius = radius;
+        b.firstSlice = 1;
+        b.lastSlice = 0;
+        if (b.depth + radius < zNear || b.depth - radius > farDepth) continue;
+        b.firstSlice = std::max(grid.sliceOf(std::max(b.depth - radius, zNear)), 0);
+        b.lastSlice = std::min(grid.sliceOf(std::min(b.depth + radius, farDepth)), grid.slices - 1);
+    }
+
+    // Count, prefix-sum into offsets, then fill; slices never share clusters
+    uint32_t* ranges = out.ranges;
+    uint16_t* indices = nullptr;
+    unsigned int sliceCount = static_cast<unsigned int>(grid.slices);
+    auto runPass = [&](bool fill) {
+        auto body = [&grid, bounds, lightCount, ranges, indices, fill](unsigned int begin, unsigned int end) {
+            for (unsigned int s = begin; s < end; s++) {
+                processSlice(grid, bounds, lightCount, static_cast<int>(s), fill, ranges, indices);
+            }
+        };
+        if (jobs) jobs->parallelFor(sliceCount, 1, body);
+        else body(0, sliceCount);
+    };
+    runPass(false);
+
+    uint32_t total = 0;
+    for (uint32_t c = 0; c < clusterCount; c++) {
+        ranges[c * 2] = total;
+        total += ranges[c * 2 + 1];
+        ranges[c * 2 + 1] = 0;
+    }
+    indices = arena.allocateArray<uint16_t>(total > 0 ? total : 1);
+    out.indices = indices;
+    out.indexCount = total;
+
+    runPass(true);
+}
@@ -0,0 +1,55 @@
+#ifndef CLUSTERS_HPP
+#define CLUSTERS_HPP
+
+#include <cstdint>
+#include "../jobs/jobs.hpp"
+#include "../math/math.hpp"
+#include "../memory/arena.hpp"
+#include "../scene/components.hpp"
+
+// Clustered forward lighting: the view frustum is cut into tilesX x tilesY
+// screen tiles and `slices` exponentially spaced depth slices (froxels), and
+// each froxel gets the list of point/spot lights whose bounds reach it. The
+// fragment shader then loops over its own froxel's lights only.
+struct ClusterSettings {
+    int tilesX = 16;
+    int tilesY = 9;
+    int slices = 24;
+    float maxDistance = 300.0f; // Clusters end here (or at zFar); farther fragments get no local lights
+    uint32_t maxLights = 4096;  // Per frame; indices are 16-bit
+};
+
+// One point or spot light as the shader reads it: three RGBA32F texels
+struct GpuLight {
+    float position[3];
+    float range;
+    float color[3];     // Color * intensity
+    float cosOuter;     // Point lights use -2 so the cone factor is always 1
+    float direction[3];
+    float cosInner;
+};
+
+GpuLight packLight(const LightComponent& light, vec3 position);
+
+// Per-frame result; all arrays live in the arena passed to assignClusters()
+struct ClusterLights {
+    const GpuLight* lights = nullptr;
+    uint32_t lightCount = 0;
+    uint32_t* ranges = nullptr;   // Offset and count into indices, per cluster
+    uint16_t* indices = nullptr;  // Light indices, grouped by cluster
+    uint32_t indexCount = 0;
+    int tilesX = 0, tilesY = 0, slices = 0;
+    float zNear = 0.1f, zFar = 1.0f; // Depth range covered by the slices
+
+    uint32_t clusterCount() const { return static_cast<uint32_t>(tilesX * tilesY * slices); }
+};
+
+// Builds the cluster light lists for world-space lights seen through view and
+// a perspective projection. Clusters are (slice * tilesY + y) * tilesX + x,
+// with x and y from NDC. Light bounds are spheres (spots use their cone's
+// bounding sphere) tested per slice against each slice's depth band, so the
+// lists are conservative. One job per slice when jobs is set.
+void assignClusters(const ClusterSettings& settings, const mat4& view, const mat4& projection, float zNear, float zFar,
+                    const GpuLight* lights, uint32_t lightCount, Arena& arena, JobSystem* jobs, ClusterLights& out);
+
+#endif
@@ -0,0 +1,73 @@
+#include "light_buffers.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const char* samplerNames[] = {"clusterLights", "clusterRanges", "clusterIndices"};
+const GLenum formats[] = {GL_RGBA32F, GL_RG32UI, GL_R16UI};
+
+} // namespace
+
+void LightBuffers::init() {
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    glGenBuffers(COUNT, buffers);
+    glGenTextures(COUNT, textures);
+    // An empty but valid grid until the first upload
+    const uint32_t empty[4] = {};
+    for (int i = 0; i < COUNT; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(empty), empty, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightBuffers::cleanup() {
+    if (buffers[0]) glDeleteBuffers(COUNT, buffers);
+    if (textures[0]) glDeleteTextures(COUNT, textures);
+    for (int i = 0; i < COUNT; i++) buffers[i] = textures[i] = 0;
+}
+
+void LightBuffers::upload(const ClusterLights& clusters) {
+    uint32_t clusterCount = clusters.clusterCount();
+    if (!buffers[0] || clusterCount == 0) return;
+
+    // A texel limit below what a frame needs drops the tail of the lists
+    size_t lightCount = std::min<size_t>(clusters.lightCount, maxTexels / 3);
+    size_t indexCount = std::min<size_t>(clusters.indexCount, maxTexels);
+    if ((lightCount < clusters.lightCount || indexCount < clusters.indexCount) && !warned) {
+        std::cerr << "LightBuffers: " << clusters.indexCount << " light indices exceed the texture buffer limit of "
+                  << maxTexels << " texels; lights will be missing" << std::endl;
+        warned = true;
+    }
+
+    const void* data[COUNT] = {clusters.lights, clusters.ranges, clusters.indices};
+    size_t bytes[COUNT] = {lightCount * sizeof(GpuLight), clusterCount * 2 * sizeof(uint32_t), indexCount * sizeof(uint16_t)};
+    for (int i = 0; i < COUNT; i++) {
+        if (bytes[i] == 0) continue; // Keep the old storage; the ranges say nothing reads it
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, bytes[i], data[i], GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    grid[0] = clusters.tilesX;
+    grid[1] = clusters.tilesY;
+    grid[2] = clusters.slices;
+    depth[0] = clusters.zNear;
+    depth[1] = clusters.slices / std::log(clusters.zFar / clusters.zNear);
+}
+
+void LightBuffers::bind(unsigned int program) const {
+    for (int i = 0; i < COUNT; i++) {
+        glActiveTexture(GL_TEXTURE0 + FIRST_UNIT + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glUniform1i(glGetUniformLocation(program, samplerNames[i]), FIRST_UNIT + i);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glUniform3iv(glGetUniformLocation(program, "clusterGrid"), 1, grid);
+    glUniform2fv(glGetUniformLocation(program, "clusterDepth"), 1, depth);
+}
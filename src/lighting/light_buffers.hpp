@@ -0,0 +1,30 @@
+#ifndef LIGHT_BUFFERS_HPP
+#define LIGHT_BUFFERS_HPP
+
+#include <glad/glad.h>
+#include "clusters.hpp"
+
+// GPU copy of a frame's ClusterLights. GL 4.1 has no storage buffers, so the
+// lists are texture buffers read with texelFetch: lights as RGBA32F (three
+// texels each), per-cluster offset/count as RG32UI and indices as R16UI.
+// Each upload orphans the previous frame's storage. Render thread only.
+struct LightBuffers {
+    static constexpr int FIRST_UNIT = 1; // Texture units FIRST_UNIT .. FIRST_UNIT + 2
+
+    void init();
+    void cleanup();
+    void upload(const ClusterLights& clusters);
+    // Binds the textures and sets the cluster uniforms of include/clusters.glsl
+    void bind(unsigned int program) const;
+
+private:
+    enum { LIGHTS, RANGES, INDICES, COUNT };
+    unsigned int buffers[COUNT] = {};
+    unsigned int textures[COUNT] = {};
+    int maxTexels = 65536;  // GL_MAX_TEXTURE_BUFFER_SIZE
+    bool warned = false;
+    int grid[3] = {1, 1, 1};
+    float depth[2] = {0.1f, 1.0f}; // zNear, slices / log(zFar / zNear)
+};
+
+#endif
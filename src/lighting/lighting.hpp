@@ -2,17 +2,17 @@
 #define LIGHTING_HPP
 
 #include <glad/glad.h>
+#include "../scene/components.hpp"
 
-// Vertex Shader with lighting
-extern const char* vertexShaderSource;
+// Lighting shader sources (ambient + diffuse), relative to the working directory
+extern const char* const lightingVertexPath;
+extern const char* const lightingFragmentPath;
 
-// Fragment Shader with basic global illumination (ambient + diffuse)
-extern const char* fragmentShaderSource;
+// Prewarm the shader program (with sun shadows) in the shader library;
+// shaderProgram is set once it has linked (see ProgramCache::poll)
+void initLightingShader(unsigned int& shaderProgram);
 
-// Initialize shader program
-unsigned int initLightingShader();
-
-// Set up lighting uniforms
-void setupLighting(unsigned int shaderProgram);
+// Set up lighting uniforms for one directional light plus fixed ambient
+void setupLighting(unsigned int shaderProgram, const LightComponent& sun);
 
 #endif
\ No newline at end of file
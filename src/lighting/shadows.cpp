@@ -0,0 +1,70 @@
+#include "shadows.hpp"
+#include <algorithm>
+#include <cmath>
+
+void fitCascades(const ShadowSettings& settings, const mat4& view, float fovY, float aspect, float zNear, float zFar,
+                 vec3 lightDirection, ShadowCascades& out) {
+    out.settings = settings;
+    out.count = std::clamp(settings.cascadeCount, 0, MAX_CASCADES);
+    mat4 inverseView;
+    if (out.count == 0 || settings.resolution <= 0 || !inverse(view, inverseView)) {
+        out.count = 0;
+        return;
+    }
+
+    vec3 forward = normalize(lightDirection);
+    vec3 up = std::fabs(forward.y) > 0.99f ? vec3{0.0f, 0.0f, 1.0f} : vec3{0.0f, 1.0f, 0.0f};
+    mat4 lightView = lookAtDirection({0.0f, 0.0f, 0.0f}, forward, up);
+
+    float tanY = std::tan(fovY * 0.5f);
+    float tanX = tanY * aspect;
+    float farDepth = std::min(zFar, settings.maxDistance);
+    float splitNear = zNear;
+    for (int c = 0; c < out.count; c++) {
+        // Blend of logarithmic and uniform split depths
+        float t = (c + 1) / float(out.count);
+        float logSplit = zNear * std::pow(farDepth / zNear, t);
+        float uniformSplit = zNear + (farDepth - zNear) * t;
+        float splitFar = settings.splitLambda * logSplit + (1.0f - settings.splitLambda) * uniformSplit;
+
+        // Bounding sphere of the slice, centered on the view axis; rounding
+        // the radius keeps float noise from changing the texel size
+        float center = 0.5f * (splitNear + splitFar);
+        float radius = 0.0f;
+        float depths[2] = {splitNear, splitFar};
+        for (float depth : depths) {
+            vec3 corner = {depth * tanX, depth * tanY, depth - center};
+            radius = std::max(radius, length(corner));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        vec4 worldCenter = inverseView * vec4{0.0f, 0.0f, -center, 1.0f};
+
+        // Snap the center to the texel grid in light space
+        float texel = 2.0f * radius / settings.resolution;
+        vec4 lightCenter = lightView * worldCenter;
+        float x = std::floor(lightCenter.x / texel) * texel;
+        float y = std::floor(lightCenter.y / texel) * texel;
+        float depth = -lightCenter.z;
+        mat4 projection = orthographic(x - radius, x + radius, y - radius, y + radius, depth - radius, depth + radius);
+
+        out.viewProjection[c] = projection * lightView;
+        out.frustum[c] = frustumFromMatrix(out.viewProjection[c]);
+        out.splitDepth[c] = splitFar;
+        out.texelSize[c] = texel;
+        splitNear = splitFar;
+    }
+}
+
+uint8_t cascadeMask(const ShadowCascades& cascades, vec3 center, float radius) {
+    uint8_t mask = 0;
+    for (int c = 0; c < cascades.count; c++) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; p++) {
+            if (p == 4) continue; // Near plane: casters toward the light still shadow
+            const vec4& plane = cascades.frustum[c].planes[p];
+            inside = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -radius;
+        }
+        if (inside) mask |= static_cast<uint8_t>(1u << c);
+    }
+    return mask;
+}
@@ -0,0 +1,43 @@
+#ifndef SHADOWS_HPP
+#define SHADOWS_HPP
+
+#include <cstdint>
+#include "../math/math.hpp"
+
+constexpr int MAX_CASCADES = 4;
+
+// Cascaded shadow maps for the sun. Fewer cascades or a lower resolution
+// trade shadow detail for depth-pass and memory cost.
+struct ShadowSettings {
+    int cascadeCount = 4;          // 0 disables shadows; at most MAX_CASCADES
+    int resolution = 2048;         // Texels per side of each cascade
+    float maxDistance = 150.0f;    // View depth the last cascade reaches
+    float splitLambda = 0.75f;     // Split spacing: 0 uniform, 1 logarithmic
+    int pcfRadius = 1;             // (2r + 1)^2 hardware-filtered taps per lookup
+    float slopeBias = 2.0f;        // glPolygonOffset in the depth pass
+    float constantBias = 2.0f;
+    float normalBias = 1.0f;       // Receiver offset along its normal, in texels
+};
+
+// One frame's cascades, fitted on the update thread
+struct ShadowCascades {
+    ShadowSettings settings;
+    int count = 0;                 // 0: no shadows this frame
+    mat4 viewProjection[MAX_CASCADES];
+    Frustum frustum[MAX_CASCADES];
+    float splitDepth[MAX_CASCADES]; // Far view depth of each cascade
+    float texelSize[MAX_CASCADES];  // World units per shadow texel
+};
+
+// Splits the view frustum by depth and fits an orthographic light projection
+// to each slice's bounding sphere. The sphere's size does not change as the
+// camera turns, and its center is snapped to whole texels in light space, so
+// shadow edges stay put instead of shimmering.
+void fitCascades(const ShadowSettings& settings, const mat4& view, float fovY, float aspect, float zNear, float zFar,
+                 vec3 lightDirection, ShadowCascades& out);
+
+// Bit c is set when a sphere may cast into cascade c. Casters between the
+// light and a cascade count too; the depth pass clamps them onto its near plane.
+uint8_t cascadeMask(const ShadowCascades& cascades, vec3 center, float radius);
+
+#endif
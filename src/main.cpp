@@ -1,8 +1,15 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include "shader/shader.hpp"
+#include "shader/shader_library.hpp"
+#include "shader/program_cache.hpp"
+#include "shader/shader_watcher.hpp"
 #include "scene/scene.hpp"
 #include "renderer/renderer.hpp"
+#include "jobs/jobs.hpp"
+#include "scene/upload_thread.hpp"
+#include "frame/frame_pipeline.hpp"
+#include "terrain/terrain.hpp"
+#include "memory/alloc_tracker.hpp"
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -32,45 +39,173 @@ int main() {
         return -1;
     }
 
+    // Linked shader programs are cached on disk; falls back to compiling
+    programCache().init("shader_cache", (GLADloadproc)glfwGetProcAddress);
+
+    // Worker threads for loading, culling and transform updates; the main
+    // thread runs jobs too whenever it waits on a JobCounter.
+    JobSystem jobs;
+    jobs.init();
+
     Camera camera;
-    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double x, double y) {
-        static_cast<Camera*>(glfwGetWindowUserPointer(w))->mouseCallback(w, x, y);
-    });
-    glfwSetWindowUserPointer(window, &camera);
 
-    // TODO: Check if to use this.
-    // Shader shader("shaders/vertex.glsl", "shaders/fragment.glsl");
-    
+    // Shader hot reload for every library variant (lighting, G-buffer,
+    // deferred, depth-only) and the files they include; update() swaps
+    // rebuilt programs in each frame
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.start(window);
+    shaderWatcher.watch(shaderLibrary());
+
     Scene scene;
-    scene.initScene();
+    scene.initScene(&jobs);
+
+    // The camera is an entity too; the pipeline picks it up in start()
+    Entity cameraEntity = scene.world.create();
+    CameraComponent lens;
+    lens.camera = &camera;
+
+    // Terrain below the ground grid; a raw 16-bit heightmap can replace the noise:
+    // terrain.loadHeightmapR16("terrain/height.r16", 1025, 1025)
+    Terrain terrain;
+    terrain.generateHeightmap(1025, 1337);
+    if (terrain.init()) {
+        scene.terrain = &terrain;
+        lens.zFar = 1500.0f;
+    }
+    scene.world.add<CameraComponent>(cameraEntity, lens);
+
+    // Optional: VBO/EBO uploads on a loader thread with a shared context
+    UploadThread uploader;
+    if (uploader.start(window)) {
+        scene.uploader = &uploader;
+    }
 
     // Add objects
     float pos1[3] = {0.0f, 0.0f, 0.0f};  // Cube at origin
     float pos2[3] = {2.0f, 0.0f, 2.0f};  // Another cube offset
     
     //scene.add("obj/cube.obj", pos1);
-    //scene.add("obj/cube.obj", pos2);      // Add as many as you want
+    //scene.addAsync("obj/cube.obj", pos2); // Non-blocking; appears once uploaded
+
+    // A ring of colored point lights and one spot light over the origin; the
+    // pipeline bins them into view clusters each frame
+    for (int i = 0; i < 8; i++) {
+        float angle = i * 2.0f * static_cast<float>(M_PI) / 8.0f;
+        float position[3] = {4.0f * std::cos(angle), 1.0f, 4.0f * std::sin(angle)};
+        LightComponent point;
+        point.type = LightType::Point;
+        point.color = {0.5f + 0.5f * std::cos(angle), 0.5f + 0.5f * std::sin(angle), 0.6f};
+        point.intensity = 4.0f;
+        point.range = 6.0f;
+        scene.addLight(point, position);
+    }
+    LightComponent spot;
+    spot.type = LightType::Spot;
+    spot.direction = {0.0f, -1.0f, 0.0f};
+    spot.intensity = 20.0f;
+    spot.range = 12.0f;
+    float spotPosition[3] = {0.0f, 8.0f, 0.0f};
+    scene.addLight(spot, spotPosition);
 
 
     Renderer renderer;
     renderer.initRenderer();
 
-    float lastFrame = 0.0f;
+    // Terrain, grid and lighting programs were only submitted; let the driver
+    // compile them side by side and keep the window responsive meanwhile,
+    // sleeping on the event queue between polls instead of spinning a core
+    while (!programCache().poll()) {
+        glfwWaitEventsTimeout(0.001);
+    }
+
+    // Camera/scene update runs one frame ahead on its own thread (0 = serial).
+    // After start() the camera belongs to the update thread.
+    const int frameLatency = 1;
+    // With -DCISCO_TRACK_ALLOCATIONS=ON, any heap allocation on the main or
+    // update thread in a frame after warm-up is reported (AllocGuardMode::Assert
+    // to abort); job workers are not guarded
+    const uint64_t warmupFrames = 120;
+    FramePipeline pipeline;
+    pipeline.allocGuardWarmup = warmupFrames;
+    pipeline.clock.step = 1.0 / 120.0;     // Fixed simulation rate
+    pipeline.clock.maxStepsPerFrame = 8;
+    pipeline.shadowSettings.cascadeCount = 4; // Fewer or smaller cascades trade quality for frame time
+    pipeline.shadowSettings.resolution = 2048;
+    if (!pipeline.start(scene, &jobs, frameLatency)) {
+        glfwTerminate();
+        return -1;
+    }
+    glfwSetCursorPosCallback(window, [](GLFWwindow* w, double x, double y) {
+        static_cast<FramePipeline*>(glfwGetWindowUserPointer(w))->onMouse(x, y);
+    });
+    glfwSetWindowUserPointer(window, &pipeline);
+
+    uint64_t frameIndex = 0;
+    bool shadingKeyHeld = false;
+    bool prepassKeyHeld = false;
+
+    double lastFrame = glfwGetTime(); // Double through to the fixed-step accumulator, which needs the precision
     while (!glfwWindowShouldClose(window)) {
-        float currentFrame = glfwGetTime();
-        float deltaTime = currentFrame - lastFrame;
+        AllocFrameGuard allocGuard(frameIndex++ >= warmupFrames, AllocGuardMode::Log);
+        double currentFrame = glfwGetTime();
+        double frameTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        camera.processInput(window, deltaTime);
-        renderer.render(scene, camera, deltaTime);
+        pipeline.sync();
+
+        // Upload meshes finished by loader jobs: at most 4 MB / 2 ms per frame.
+        // Loading and shader reloads are not steady state, so they may allocate.
+        {
+            AllocGuardPause pause;
+            scene.processUploads(4 * 1024 * 1024, 2.0);
+            shaderWatcher.update();
+        }
+
+        // F1 switches between forward and deferred shading, reporting the GPU
+        // time the previous path spent on objects
+        bool shadingKey = glfwGetKey(window, GLFW_KEY_F1) == GLFW_PRESS;
+        if (shadingKey && !shadingKeyHeld) {
+            AllocGuardPause pause;
+            bool deferred = renderer.shading == ShadingPath::Deferred;
+            std::cout << (deferred ? "Deferred" : "Forward") << " objects: " << renderer.objectTimer.averageMs()
+                      << " ms GPU, shadows: " << renderer.shadowTimer.averageMs() << " ms; switching to "
+                      << (deferred ? "forward" : "deferred") << std::endl;
+            renderer.shading = deferred ? ShadingPath::Forward : ShadingPath::Deferred;
+            renderer.objectTimer.reset();
+            renderer.shadowTimer.reset();
+        }
+        shadingKeyHeld = shadingKey;
+
+        // F2 toggles the depth pre-pass the same way
+        bool prepassKey = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
+        if (prepassKey && !prepassKeyHeld) {
+            AllocGuardPause pause;
+            std::cout << "Objects " << (renderer.depthPrepass ? "with" : "without") << " depth pre-pass: "
+                      << renderer.objectTimer.averageMs() << " ms GPU; pre-pass "
+                      << (renderer.depthPrepass ? "off" : "on") << std::endl;
+            renderer.depthPrepass = !renderer.depthPrepass;
+            renderer.objectTimer.reset();
+            renderer.shadowTimer.reset();
+        }
+        prepassKeyHeld = prepassKey;
+
+        pipeline.kick(window, frameTime);
+        renderer.render(scene, pipeline.current());
 
         // Swap buffers and poll events
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    pipeline.stop();
+    shaderWatcher.stop();
+    printAllocReport();
+    pipeline.printArenaStats();
+    printArenaStats("main scratch", scratchArena());
     scene.cleanupScene();
-    glDeleteProgram(renderer.shaderProgram);
+    terrain.cleanup();
+    renderer.cleanupRenderer();
+    jobs.shutdown();
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
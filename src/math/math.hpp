@@ -0,0 +1,448 @@
+#ifndef MATH_HPP
+#define MATH_HPP
+
+// Header-only vector/matrix/quaternion math. Matrices are column-major like
+// OpenGL, so mat4::m can be passed straight to glUniformMatrix4fv.
+//
+// Kernels pick SSE (x86-64 baseline) or AVX (CISCO_ENABLE_AVX / -mavx) at
+// compile time; every kernel also has a *Scalar version used as the fallback
+// on other architectures and as the reference in bench/bench_math.cpp.
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CISCO_MATH_SSE 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define CISCO_MATH_AVX 1
+#include <immintrin.h>
+#endif
+
+struct vec3 {
+    float x, y, z;
+};
+
+struct alignas(16) vec4 {
+    float x, y, z, w;
+};
+
+struct alignas(16) quat {
+    float x, y, z, w; // w is the scalar part
+};
+
+struct alignas(16) mat4 {
+    float m[16]; // m[col * 4 + row]
+
+    float& operator()(int row, int col) { return m[col * 4 + row]; }
+    float operator()(int row, int col) const { return m[col * 4 + row]; }
+};
+
+struct mat3 {
+    float m[9]; // m[col * 3 + row]
+};
+
+// ---- vec3 -----------------------------------------------------------------
+
+inline vec3 operator+(vec3 a, vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline vec3 operator-(vec3 a, vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline vec3 operator-(vec3 a) { return {-a.x, -a.y, -a.z}; }
+inline vec3 operator*(vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+inline vec3 operator*(float s, vec3 a) { return a * s; }
+inline vec3 lerp(vec3 a, vec3 b, float t) { return a + (b - a) * t; }
+
+inline float dot(vec3 a, vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline vec3 cross(vec3 a, vec3 b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline float length(vec3 a) { return std::sqrt(dot(a, a)); }
+inline vec3 normalize(vec3 a) {
+    float len = length(a);
+    return len > 0.0f ? a * (1.0f / len) : a;
+}
+
+// ---- quat -----------------------------------------------------------------
+
+inline quat quatIdentity() { return {0.0f, 0.0f, 0.0f, 1.0f}; }
+
+inline quat quatFromAxisAngle(vec3 axis, float radians) {
+    vec3 n = normalize(axis);
+    float s = std::sin(radians * 0.5f);
+    return {n.x * s, n.y * s, n.z * s, std::cos(radians * 0.5f)};
+}
+
+inline quat operator*(quat a, quat b) {
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+    };
+}
+
+inline quat normalize(quat q) {
+    float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    return {q.x * inv, q.y * inv, q.z * inv, q.w * inv};
+}
+
+inline vec3 rotate(quat q, vec3 v) {
+    vec3 u = {q.x, q.y, q.z};
+    vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+// Normalized lerp along the shortest arc; close enough to slerp for
+// interpolating between simulation steps.
+inline quat nlerp(quat a, quat b, float t) {
+    float d = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    float s = d < 0.0f ? -t : t;
+    float r = 1.0f - t;
+    return normalize(quat{a.x * r + b.x * s, a.y * r + b.y * s, a.z * r + b.z * s, a.w * r + b.w * s});
+}
+
+// ---- mat4 construction ----------------------------------------------------
+
+inline mat4 mat4Identity() {
+    return {{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+inline mat4 mat4Translation(vec3 t) {
+    mat4 r = mat4Identity();
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z;
+    return r;
+}
+
+// Translation * rotation * scale in one go (the usual object transform)
+inline mat4 mat4FromTRS(vec3 t, quat q, vec3 s) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    mat4 r;
+    r.m[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+    r.m[1] = (2.0f * (xy + wz)) * s.x;
+    r.m[2] = (2.0f * (xz - wy)) * s.x;
+    r.m[3] = 0.0f;
+    r.m[4] = (2.0f * (xy - wz)) * s.y;
+    r.m[5] = (1.0f - 2.0f * (xx + zz)) * s.y;
+    r.m[6] = (2.0f * (yz + wx)) * s.y;
+    r.m[7] = 0.0f;
+    r.m[8] = (2.0f * (xz + wy)) * s.z;
+    r.m[9] = (2.0f * (yz - wx)) * s.z;
+    r.m[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+    r.m[11] = 0.0f;
+    r.m[12] = t.x; r.m[13] = t.y; r.m[14] = t.z; r.m[15] = 1.0f;
+    return r;
+}
+
+inline mat4 mat4FromQuat(quat q) { return mat4FromTRS({0.0f, 0.0f, 0.0f}, q, {1.0f, 1.0f, 1.0f}); }
+
+// Right-handed view matrix looking from eye along forward (OpenGL convention)
+inline mat4 lookAtDirection(vec3 eye, vec3 forward, vec3 up) {
+    vec3 f = normalize(forward);
+    vec3 s = normalize(cross(f, up));
+    vec3 u = cross(s, f);
+    mat4 r;
+    r.m[0] = s.x; r.m[4] = s.y; r.m[8] = s.z;  r.m[12] = -dot(s, eye);
+    r.m[1] = u.x; r.m[5] = u.y; r.m[9] = u.z;  r.m[13] = -dot(u, eye);
+    r.m[2] = -f.x; r.m[6] = -f.y; r.m[10] = -f.z; r.m[14] = dot(f, eye);
+    r.m[3] = 0.0f; r.m[7] = 0.0f; r.m[11] = 0.0f; r.m[15] = 1.0f;
+    return r;
+}
+
+inline mat4 lookAt(vec3 eye, vec3 target, vec3 up) { return lookAtDirection(eye, target - eye, up); }
+
+// OpenGL clip space (z in [-1, 1]); fovy in radians
+inline mat4 perspective(float fovy, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovy * 0.5f);
+    mat4 r = {};
+    r.m[0] = f / aspect;
+    r.m[5] = f;
+    r.m[10] = -(zFar + zNear) / (zFar - zNear);
+    r.m[11] = -1.0f;
+    r.m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+    return r;
+}
+
+// OpenGL clip space (z in [-1, 1]); depths are distances along -z in view space
+inline mat4 orthographic(float left, float right, float bottom, float top, float zNear, float zFar) {
+    mat4 r = {};
+    r.m[0] = 2.0f / (right - left);
+    r.m[5] = 2.0f / (top - bottom);
+    r.m[10] = -2.0f / (zFar - zNear);
+    r.m[12] = -(right + left) / (right - left);
+    r.m[13] = -(top + bottom) / (top - bottom);
+    r.m[14] = -(zFar + zNear) / (zFar - zNear);
+    r.m[15] = 1.0f;
+    return r;
+}
+
+// ---- normal matrices ------------------------------------------------------
+
+// Upper-left 3x3; the normal matrix of rotation plus uniform scale, up to a
+// positive factor (shaders renormalize)
+inline mat3 mat3FromMat4(const mat4& a) {
+    return {{a.m[0], a.m[1], a.m[2], a.m[4], a.m[5], a.m[6], a.m[8], a.m[9], a.m[10]}};
+}
+
+// Inverse transpose of the upper-left 3x3 for any transform: its columns are
+// the cross products of the other two columns, over the determinant
+inline mat3 normalMatrix(const mat4& a) {
+    vec3 c0 = {a.m[0], a.m[1], a.m[2]}, c1 = {a.m[4], a.m[5], a.m[6]}, c2 = {a.m[8], a.m[9], a.m[10]};
+    vec3 n0 = cross(c1, c2), n1 = cross(c2, c0), n2 = cross(c0, c1);
+    float det = dot(c0, n0);
+    float inv = det != 0.0f ? 1.0f / det : 0.0f;
+    return {{n0.x * inv, n0.y * inv, n0.z * inv, n1.x * inv, n1.y * inv, n1.z * inv, n2.x * inv, n2.y * inv, n2.z * inv}};
+}
+
+// Clip planes (xyz normal pointing inward, w distance) of projection * view
+struct Frustum {
+    vec4 planes[6];
+};
+
+inline Frustum frustumFromMatrix(const mat4& m) {
+    Frustum f;
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f; // left/right, bottom/top, near/far
+        vec4 p = {m.m[3] + sign * m.m[row], m.m[7] + sign * m.m[4 + row],
+                  m.m[11] + sign * m.m[8 + row], m.m[15] + sign * m.m[12 + row]};
+        float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        f.planes[i] = {p.x / len, p.y / len, p.z / len, p.w / len};
+    }
+    return f;
+}
+
+inline bool frustumIntersectsAabb(const Frustum& f, vec3 lo, vec3 hi) {
+    for (const vec4& p : f.planes) {
+        // Corner furthest along the plane normal
+        vec3 v = {p.x >= 0.0f ? hi.x : lo.x, p.y >= 0.0f ? hi.y : lo.y, p.z >= 0.0f ? hi.z : lo.z};
+        if (p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+inline bool frustumIntersectsSphere(const Frustum& f, vec3 center, float radius) {
+    for (const vec4& p : f.planes) {
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) return false;
+    }
+    return true;
+}
+
+// ---- scalar kernels -------------------------------------------------------
+
+inline mat4 mulScalar(const mat4& a, const mat4& b) {
+    mat4 r;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) sum += a.m[k * 4 + row] * b.m[col * 4 + k];
+            r.m[col * 4 + row] = sum;
+        }
+    }
+    return r;
+}
+
+inline vec4 mulScalar(const mat4& a, vec4 v) {
+    return {
+        a.m[0] * v.x + a.m[4] * v.y + a.m[8] * v.z + a.m[12] * v.w,
+        a.m[1] * v.x + a.m[5] * v.y + a.m[9] * v.z + a.m[13] * v.w,
+        a.m[2] * v.x + a.m[6] * v.y + a.m[10] * v.z + a.m[14] * v.w,
+        a.m[3] * v.x + a.m[7] * v.y + a.m[11] * v.z + a.m[15] * v.w,
+    };
+}
+
+// Cofactor expansion; returns false (and leaves out untouched) if singular
+inline bool inverseScalar(const mat4& a, mat4& out) {
+    const float* m = a.m;
+    float inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) return false;
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; i++) out.m[i] = inv[i] * invDet;
+    return true;
+}
+
+// Affine points (w = 1) stored as separate x/y/z arrays; in and out may alias
+inline void transformPointsScalar(const mat4& a, const float* xs, const float* ys, const float* zs,
+                                  float* ox, float* oy, float* oz, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float x = xs[i], y = ys[i], z = zs[i];
+        ox[i] = a.m[0] * x + a.m[4] * y + a.m[8] * z + a.m[12];
+        oy[i] = a.m[1] * x + a.m[5] * y + a.m[9] * z + a.m[13];
+        oz[i] = a.m[2] * x + a.m[6] * y + a.m[10] * z + a.m[14];
+    }
+}
+
+// ---- SIMD kernels ---------------------------------------------------------
+
+#if CISCO_MATH_SSE
+namespace simd_detail {
+
+#define CISCO_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, (x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define CISCO_SWIZZLE(v, x, y, z, w) CISCO_SHUFFLE(v, v, x, y, z, w)
+
+// 2x2 blocks stored as (m00, m01, m10, m11)
+inline __m128 mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, CISCO_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(CISCO_SWIZZLE(a, 1, 0, 3, 2), CISCO_SWIZZLE(b, 2, 1, 2, 1)));
+}
+// adj(a) * b
+inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(CISCO_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(CISCO_SWIZZLE(a, 1, 1, 2, 2), CISCO_SWIZZLE(b, 2, 3, 0, 1)));
+}
+// a * adj(b)
+inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, CISCO_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(CISCO_SWIZZLE(a, 1, 0, 3, 2), CISCO_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+} // namespace simd_detail
+#endif
+
+inline mat4 mul(const mat4& a, const mat4& b) {
+#if CISCO_MATH_SSE
+    __m128 a0 = _mm_load_ps(a.m), a1 = _mm_load_ps(a.m + 4), a2 = _mm_load_ps(a.m + 8), a3 = _mm_load_ps(a.m + 12);
+    mat4 r;
+    for (int col = 0; col < 4; col++) {
+        const float* bc = b.m + col * 4;
+        __m128 v = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        v = _mm_add_ps(v, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        v = _mm_add_ps(v, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        v = _mm_add_ps(v, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_store_ps(r.m + col * 4, v);
+    }
+    return r;
+#else
+    return mulScalar(a, b);
+#endif
+}
+
+inline vec4 mul(const mat4& a, vec4 v) {
+#if CISCO_MATH_SSE
+    __m128 r = _mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.w)));
+    vec4 out;
+    _mm_store_ps(&out.x, r);
+    return out;
+#else
+    return mulScalar(a, v);
+#endif
+}
+
+inline mat4 operator*(const mat4& a, const mat4& b) { return mul(a, b); }
+inline vec4 operator*(const mat4& a, vec4 v) { return mul(a, v); }
+
+// General inverse via 2x2 block decomposition. Column-major storage just
+// means the blocks are transposed, which the method is symmetric under.
+inline bool inverse(const mat4& a, mat4& out) {
+#if CISCO_MATH_SSE
+    using namespace simd_detail;
+    __m128 c0 = _mm_load_ps(a.m), c1 = _mm_load_ps(a.m + 4), c2 = _mm_load_ps(a.m + 8), c3 = _mm_load_ps(a.m + 12);
+
+    __m128 A = _mm_movelh_ps(c0, c1);
+    __m128 B = _mm_movehl_ps(c1, c0);
+    __m128 C = _mm_movelh_ps(c2, c3);
+    __m128 D = _mm_movehl_ps(c3, c2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(CISCO_SHUFFLE(c0, c2, 0, 2, 0, 2), CISCO_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(CISCO_SHUFFLE(c0, c2, 1, 3, 1, 3), CISCO_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 detA = CISCO_SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = CISCO_SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = CISCO_SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = CISCO_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 dc = mat2AdjMul(D, C);
+    __m128 ab = mat2AdjMul(A, B);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, dc));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 tr = _mm_mul_ps(ab, CISCO_SWIZZLE(dc, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, CISCO_SWIZZLE(tr, 2, 3, 0, 1));
+    tr = _mm_add_ps(tr, CISCO_SWIZZLE(tr, 1, 0, 3, 2));
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+    if (_mm_cvtss_f32(detM) == 0.0f) return false;
+
+    __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    x = _mm_mul_ps(x, rDetM);
+    y = _mm_mul_ps(y, rDetM);
+    z = _mm_mul_ps(z, rDetM);
+    w = _mm_mul_ps(w, rDetM);
+
+    _mm_store_ps(out.m, CISCO_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_store_ps(out.m + 4, CISCO_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_store_ps(out.m + 8, CISCO_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_store_ps(out.m + 12, CISCO_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+#else
+    return inverseScalar(a, out);
+#endif
+}
+
+inline void transformPoints(const mat4& a, const float* xs, const float* ys, const float* zs,
+                            float* ox, float* oy, float* oz, size_t count) {
+    size_t i = 0;
+#if CISCO_MATH_AVX
+    {
+        __m256 m0 = _mm256_set1_ps(a.m[0]), m1 = _mm256_set1_ps(a.m[1]), m2 = _mm256_set1_ps(a.m[2]);
+        __m256 m4 = _mm256_set1_ps(a.m[4]), m5 = _mm256_set1_ps(a.m[5]), m6 = _mm256_set1_ps(a.m[6]);
+        __m256 m8 = _mm256_set1_ps(a.m[8]), m9 = _mm256_set1_ps(a.m[9]), m10 = _mm256_set1_ps(a.m[10]);
+        __m256 t0 = _mm256_set1_ps(a.m[12]), t1 = _mm256_set1_ps(a.m[13]), t2 = _mm256_set1_ps(a.m[14]);
+        for (; i + 8 <= count; i += 8) {
+            __m256 x = _mm256_loadu_ps(xs + i), y = _mm256_loadu_ps(ys + i), z = _mm256_loadu_ps(zs + i);
+            __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m4, y)), _mm256_add_ps(_mm256_mul_ps(m8, z), t0));
+            __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, x), _mm256_mul_ps(m5, y)), _mm256_add_ps(_mm256_mul_ps(m9, z), t1));
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, x), _mm256_mul_ps(m6, y)), _mm256_add_ps(_mm256_mul_ps(m10, z), t2));
+            _mm256_storeu_ps(ox + i, rx);
+            _mm256_storeu_ps(oy + i, ry);
+            _mm256_storeu_ps(oz + i, rz);
+        }
+    }
+#endif
+#if CISCO_MATH_SSE
+    {
+        __m128 m0 = _mm_set1_ps(a.m[0]), m1 = _mm_set1_ps(a.m[1]), m2 = _mm_set1_ps(a.m[2]);
+        __m128 m4 = _mm_set1_ps(a.m[4]), m5 = _mm_set1_ps(a.m[5]), m6 = _mm_set1_ps(a.m[6]);
+        __m128 m8 = _mm_set1_ps(a.m[8]), m9 = _mm_set1_ps(a.m[9]), m10 = _mm_set1_ps(a.m[10]);
+        __m128 t0 = _mm_set1_ps(a.m[12]), t1 = _mm_set1_ps(a.m[13]), t2 = _mm_set1_ps(a.m[14]);
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_loadu_ps(xs + i), y = _mm_loadu_ps(ys + i), z = _mm_loadu_ps(zs + i);
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), t0));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), t1));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), t2));
+            _mm_storeu_ps(ox + i, rx);
+            _mm_storeu_ps(oy + i, ry);
+            _mm_storeu_ps(oz + i, rz);
+        }
+    }
+#endif
+    transformPointsScalar(a, xs + i, ys + i, zs + i, ox + i, oy + i, oz + i, count - i);
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "alloc_tracker.hpp"
+#include <cstdio>
+
+#if CISCO_TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct TagCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> liveBytes{0};
+    std::atomic<uint64_t> peakLiveBytes{0};
+};
+
+TagCounters counters[static_cast<int>(AllocTag::Count)];
+std::atomic<uint64_t> violations{0};
+
+thread_local AllocTag currentTag = AllocTag::Untagged;
+thread_local bool guardActive = false;
+thread_local AllocGuardMode guardMode = AllocGuardMode::Log;
+thread_local bool reporting = false;
+
+// Sits in front of every tracked block; 16 bytes keeps default alignment
+struct Header {
+    uint64_t size;
+    uint32_t tag;
+    uint32_t offset; // From the malloc'd pointer to the user pointer
+};
+static_assert(sizeof(Header) == 16, "Header must preserve 16-byte alignment");
+
+void* trackedAlloc(size_t size, size_t align) {
+    if (guardActive && !reporting) {
+        reporting = true;
+        violations.fetch_add(1, std::memory_order_relaxed);
+        std::fprintf(stderr, "AllocFrameGuard: %zu-byte allocation (tag %s) inside a guarded frame\n",
+                     size, allocTagName(currentTag));
+        if (guardMode == AllocGuardMode::Assert) std::abort();
+        reporting = false;
+    }
+
+    size_t offset = align > sizeof(Header) ? align : sizeof(Header);
+    unsigned char* raw = static_cast<unsigned char*>(std::malloc(size + offset + (align > sizeof(Header) ? align : 0)));
+    if (!raw) return nullptr;
+    uintptr_t user = reinterpret_cast<uintptr_t>(raw) + offset;
+    if (align > sizeof(Header)) user = (user + align - 1) & ~(uintptr_t(align) - 1);
+
+    Header* header = reinterpret_cast<Header*>(user) - 1;
+    header->size = size;
+    header->tag = static_cast<uint32_t>(currentTag);
+    header->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(raw));
+
+    TagCounters& c = counters[header->tag];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(size, std::memory_order_relaxed);
+    uint64_t live = c.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = c.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return reinterpret_cast<void*>(user);
+}
+
+void trackedFree(void* ptr) {
+    if (!ptr) return;
+    Header* header = static_cast<Header*>(ptr) - 1;
+    TagCounters& c = counters[header->tag];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(static_cast<unsigned char*>(ptr) - header->offset);
+}
+
+void* allocOrThrow(size_t size, size_t align) {
+    void* ptr = trackedAlloc(size, align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+} // namespace
+
+AllocTagScope::AllocTagScope(AllocTag tag) : previous(currentTag) {
+    currentTag = tag;
+}
+
+AllocTagScope::~AllocTagScope() {
+    currentTag = previous;
+}
+
+AllocFrameGuard::AllocFrameGuard(bool active, AllocGuardMode mode) : wasActive(guardActive), previousMode(guardMode) {
+    guardActive = active;
+    guardMode = mode;
+}
+
+AllocFrameGuard::~AllocFrameGuard() {
+    guardActive = wasActive;
+    guardMode = previousMode;
+}
+
+AllocGuardPause::AllocGuardPause() : wasActive(guardActive) {
+    guardActive = false;
+}
+
+AllocGuardPause::~AllocGuardPause() {
+    guardActive = wasActive;
+}
+
+bool allocTrackingEnabled() {
+    return true;
+}
+
+AllocStats allocStats(AllocTag tag) {
+    const TagCounters& c = counters[static_cast<int>(tag)];
+    return {c.allocations.load(), c.frees.load(), c.bytes.load(), c.liveBytes.load(), c.peakLiveBytes.load()};
+}
+
+uint64_t allocGuardViolations() {
+    return violations.load();
+}
+
+void* operator new(size_t size) { return allocOrThrow(size, 0); }
+void* operator new[](size_t size) { return allocOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return allocOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return allocOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size, static_cast<size_t>(align));
+}
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+#else
+
+bool allocTrackingEnabled() {
+    return false;
+}
+
+AllocStats allocStats(AllocTag) {
+    return {0, 0, 0, 0, 0};
+}
+
+uint64_t allocGuardViolations() {
+    return 0;
+}
+
+#endif
+
+const char* allocTagName(AllocTag tag) {
+    switch (tag) {
+        case AllocTag::Untagged: return "untagged";
+        case AllocTag::Scene: return "scene";
+        case AllocTag::Renderer: return "renderer";
+        case AllocTag::Loader: return "loader";
+        case AllocTag::Shader: return "shader";
+        default: return "?";
+    }
+}
+
+void printAllocReport() {
+    if (!allocTrackingEnabled()) return;
+    std::printf("%-10s %12s %12s %14s %12s %12s\n", "tag", "allocs", "frees", "total KB", "live KB", "peak KB");
+    for (int t = 0; t < static_cast<int>(AllocTag::Count); t++) {
+        AllocStats s = allocStats(static_cast<AllocTag>(t));
+        std::printf("%-10s %12llu %12llu %14llu %12llu %12llu\n", allocTagName(static_cast<AllocTag>(t)),
+                    (unsigned long long)s.allocations, (unsigned long long)s.frees, (unsigned long long)(s.bytes / 1024),
+                    (unsigned long long)(s.liveBytes / 1024), (unsigned long long)(s.peakLiveBytes / 1024));
+    }
+    std::printf("guarded-frame allocations: %llu\n", (unsigned long long)allocGuardViolations());
+}
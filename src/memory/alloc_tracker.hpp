@@ -0,0 +1,91 @@
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <cstdint>
+
+// Heap allocation tracking, compiled in with -DCISCO_TRACK_ALLOCATIONS=ON.
+// Global operator new/delete are replaced to count allocations per subsystem
+// tag, and AllocFrameGuard reports (or aborts on) any allocation made by the
+// guarded thread while it is alive. Without the option every call here is a
+// no-op and the stats read zero.
+
+enum class AllocTag : uint8_t {
+    Untagged,
+    Scene,
+    Renderer,
+    Loader,
+    Shader,
+    Count
+};
+
+enum class AllocGuardMode {
+    Log,    // Print each offending allocation to stderr
+    Assert  // Print, then abort
+};
+
+struct AllocStats {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;          // Total ever allocated
+    uint64_t liveBytes;
+    uint64_t peakLiveBytes;
+};
+
+bool allocTrackingEnabled();
+const char* allocTagName(AllocTag tag);
+AllocStats allocStats(AllocTag tag);
+uint64_t allocGuardViolations();
+void printAllocReport(); // Per-tag table to stdout
+
+#if CISCO_TRACK_ALLOCATIONS
+
+// Attributes allocations made by this thread to a subsystem until destroyed
+struct AllocTagScope {
+    explicit AllocTagScope(AllocTag tag);
+    ~AllocTagScope();
+    AllocTagScope(const AllocTagScope&) = delete;
+    AllocTagScope& operator=(const AllocTagScope&) = delete;
+private:
+    AllocTag previous;
+};
+
+// This thread must not allocate while the guard is alive (when active). The
+// guard is per thread: FramePipeline puts one on its update thread, but job
+// workers running parallelFor/parallelEach chunks stay unguarded.
+struct AllocFrameGuard {
+    AllocFrameGuard(bool active, AllocGuardMode mode);
+    ~AllocFrameGuard();
+    AllocFrameGuard(const AllocFrameGuard&) = delete;
+    AllocFrameGuard& operator=(const AllocFrameGuard&) = delete;
+private:
+    bool wasActive;
+    AllocGuardMode previousMode;
+};
+
+// Lifts the guard for work that may legitimately allocate, e.g. uploads
+struct AllocGuardPause {
+    AllocGuardPause();
+    ~AllocGuardPause();
+    AllocGuardPause(const AllocGuardPause&) = delete;
+    AllocGuardPause& operator=(const AllocGuardPause&) = delete;
+private:
+    bool wasActive;
+};
+
+#else
+
+struct AllocTagScope {
+    explicit AllocTagScope(AllocTag) {}
+};
+
+struct AllocFrameGuard {
+    AllocFrameGuard(bool, AllocGuardMode) {}
+};
+
+struct AllocGuardPause {
+    AllocGuardPause() {}
+};
+
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+#include "arena.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace {
+size_t alignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : used(other.used), overflowBytes(other.overflowBytes), peak(other.peak), growths(other.growths),
+      base(other.base), size(other.size), overflow(std::move(other.overflow)) {
+    other.base = nullptr;
+    other.size = other.used = other.overflowBytes = 0;
+    other.overflow.clear();
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this == &other) return *this;
+    cleanup();
+    used = other.used;
+    overflowBytes = other.overflowBytes;
+    peak = other.peak;
+    growths = other.growths;
+    base = other.base;
+    size = other.size;
+    overflow = std::move(other.overflow);
+    other.base = nullptr;
+    other.size = other.used = other.overflowBytes = 0;
+    other.overflow.clear();
+    return *this;
+}
+
+void Arena::init(size_t capacity) {
+    cleanup();
+    size = alignUp(capacity, 64);
+    base = static_cast<unsigned char*>(::operator new(size, std::align_val_t(64)));
+    used = 0;
+}
+
+void Arena::cleanup() {
+    for (Block& block : overflow) {
+        std::free(block.memory);
+    }
+    overflow.clear();
+    overflowBytes = 0;
+    if (base) ::operator delete(base, std::align_val_t(64));
+    base = nullptr;
+    size = 0;
+    used = 0;
+}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+    size_t offset = alignUp(used, align);
+    if (base && offset + bytes <= size) {
+        used = offset + bytes;
+        if (used + overflowBytes > peak) peak = used + overflowBytes;
+        return base + offset;
+    }
+
+    // Out of room: a one-off block until the next reset() resizes the arena
+    size_t blockBytes = alignUp(bytes + align, 64);
+    unsigned char* block = static_cast<unsigned char*>(std::malloc(blockBytes));
+    if (!block) throw std::bad_alloc();
+    overflow.push_back({block, blockBytes});
+    overflowBytes += blockBytes;
+    if (used + overflowBytes > peak) peak = used + overflowBytes;
+    return block + (alignUp(reinterpret_cast<uintptr_t>(block), align) - reinterpret_cast<uintptr_t>(block));
+}
+
+void Arena::reset() {
+    if (!overflow.empty()) {
+        init(peak + peak / 4);
+        growths++;
+    }
+    used = 0;
+}
+
+void Arena::rewind(Marker marker) {
+    if (marker.used == 0 && marker.overflowBlocks == 0) {
+        reset();
+        return;
+    }
+    while (overflow.size() > marker.overflowBlocks) {
+        std::free(overflow.back().memory);
+        overflowBytes -= overflow.back().bytes;
+        overflow.pop_back();
+    }
+    used = marker.used;
+}
+
+Arena& scratchArena() {
+    thread_local Arena arena;
+    if (arena.capacity() == 0) arena.init(1 << 20);
+    return arena;
+}
+
+void printArenaStats(const char* name, const Arena& arena) {
+    std::cout << "arena " << name << ": capacity " << arena.capacity() / 1024 << " KB, peak " << arena.peak / 1024
+              << " KB, growths " << arena.growths << std::endl;
+}
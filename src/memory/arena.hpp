@@ -0,0 +1,95 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Linear allocator: allocate() bumps an offset, reset() frees everything at
+// once. When a frame needs more than the block holds, the extra comes from
+// overflow blocks and the next reset() grows the block to the peak, so a
+// steady-state frame settles at zero heap allocations. Not thread-safe.
+struct Arena {
+    struct Marker {
+        size_t used;
+        size_t overflowBlocks;
+    };
+
+    // Statistics
+    size_t used = 0;          // Bytes in the main block, including alignment padding
+    size_t overflowBytes = 0; // Bytes in overflow blocks since the last reset
+    size_t peak = 0;          // High-water mark of used + overflowBytes
+    size_t growths = 0;       // Times reset() had to reallocate the main block
+
+    Arena() = default;
+    Arena(const Arena&) = delete; // Owns its blocks
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept; // Frees this arena's blocks first
+    ~Arena() { cleanup(); }
+
+    void init(size_t capacity);
+    void cleanup();
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset();
+    Marker mark() const { return {used, overflow.size()}; }
+    void rewind(Marker marker); // Frees everything allocated after mark()
+    size_t capacity() const { return size; }
+
+private:
+    unsigned char* base = nullptr;
+    size_t size = 0;
+    struct Block {
+        void* memory;
+        size_t bytes;
+    };
+    std::vector<Block> overflow;
+};
+
+// Rewinds an arena on scope exit; nests.
+struct ArenaScope {
+    Arena& arena;
+    Arena::Marker marker;
+    explicit ArenaScope(Arena& a) : arena(a), marker(a.mark()) {}
+    ~ArenaScope() { arena.rewind(marker); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// Per-thread scratch arena for loaders and jobs; 1 MB to start, grows to peak.
+Arena& scratchArena();
+
+// One line of statistics (capacity, peak, growths) to stdout
+void printArenaStats(const char* name, const Arena& arena);
+
+// STL allocator over an Arena; deallocate is a no-op. Containers must not
+// outlive the next reset()/rewind() of their arena.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena& a) : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->allocateArray<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fixed-size object pool. Slots come from pages of PageSize objects and are
+// recycled through an intrusive free list, so steady churn never reaches the
+// heap; pages are only returned by clear() or the destructor. Not thread-safe.
+template <typename T, size_t PageSize = 64>
+struct Pool {
+    // Statistics
+    size_t live = 0;
+    size_t peak = 0;
+
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() { clear(); }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (!freeList) addPage();
+        Slot* slot = freeList;
+        freeList = slot->next;
+        live++;
+        if (live > peak) peak = live;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* object) {
+        if (!object) return;
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    size_t capacity() const { return pages.size() * PageSize; }
+
+    // Frees every page; objects still alive are not destroyed
+    void clear() {
+        for (Slot* page : pages) {
+            ::operator delete(page, std::align_val_t(alignof(Slot)));
+        }
+        pages.clear();
+        freeList = nullptr;
+        live = 0;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Slot* freeList = nullptr;
+    std::vector<Slot*> pages;
+
+    void addPage() {
+        Slot* page = static_cast<Slot*>(::operator new(sizeof(Slot) * PageSize, std::align_val_t(alignof(Slot))));
+        pages.push_back(page);
+        for (size_t i = PageSize; i-- > 0;) {
+            page[i].next = freeList;
+            freeList = &page[i];
+        }
+    }
+};
+
+#endif
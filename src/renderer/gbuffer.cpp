@@ -0,0 +1,64 @@
+#include "gbuffer.hpp"
+#include <iostream>
+
+namespace {
+
+unsigned int createTarget(GLenum internalFormat, GLenum format, GLenum type, int width, int height) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+} // namespace
+
+bool GBuffer::resize(int newWidth, int newHeight) {
+    if (fbo && newWidth == width && newHeight == height) return true;
+    cleanup();
+    if (newWidth <= 0 || newHeight <= 0) return false;
+    width = newWidth;
+    height = newHeight;
+
+    albedo = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    normal = createTarget(GL_RG16F, GL_RG, GL_HALF_FLOAT, width, height);
+    depth = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "GBuffer: framebuffer incomplete (0x" << std::hex << status << std::dec << ")" << std::endl;
+        cleanup();
+        return false;
+    }
+    return true;
+}
+
+void GBuffer::cleanup() {
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    unsigned int textures[3] = {albedo, normal, depth};
+    if (albedo) glDeleteTextures(3, textures);
+    fbo = albedo = normal = depth = 0;
+    width = height = 0;
+}
+
+void GBuffer::bindTextures() const {
+    unsigned int textures[3] = {albedo, normal, depth};
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + FIRST_UNIT + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
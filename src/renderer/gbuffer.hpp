@@ -0,0 +1,22 @@
+#ifndef GBUFFER_HPP
+#define GBUFFER_HPP
+
+#include <glad/glad.h>
+
+// Render targets of the deferred geometry pass: albedo (RGBA8), octahedral
+// normals (RG16F) and depth (24-bit, sampled by the lighting pass). World
+// positions are rebuilt from depth rather than stored.
+struct GBuffer {
+    static constexpr int FIRST_UNIT = 4; // Albedo, normal, depth on units 4..6
+
+    unsigned int fbo = 0;
+    unsigned int albedo = 0, normal = 0, depth = 0;
+    int width = 0, height = 0;
+
+    // (Re)creates the targets when the size changed; false if incomplete
+    bool resize(int newWidth, int newHeight);
+    void cleanup();
+    void bindTextures() const; // Onto FIRST_UNIT..FIRST_UNIT + 2
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "gpu_timer.hpp"
+
+void GpuTimer::init() {
+    glGenQueries(LATENCY, queries);
+}
+
+void GpuTimer::cleanup() {
+    if (queries[0]) glDeleteQueries(LATENCY, queries);
+    for (unsigned int& query : queries) query = 0;
+    next = pending = 0;
+    running = false;
+}
+
+void GpuTimer::begin() {
+    if (!queries[0] || pending == LATENCY) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    running = true;
+}
+
+void GpuTimer::end() {
+    if (!running) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    running = false;
+    next = (next + 1) % LATENCY;
+    pending++;
+    collect();
+}
+
+void GpuTimer::collect(bool wait) {
+    while (pending > 0) {
+        unsigned int query = queries[(next - pending + LATENCY) % LATENCY];
+        if (!wait) {
+            GLint available = 0;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        totalMs += nanoseconds * 1e-6;
+        samples++;
+        pending--;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef GPU_TIMER_HPP
+#define GPU_TIMER_HPP
+
+#include <glad/glad.h>
+#include <cstdint>
+
+// GPU time of a span of commands via GL_TIME_ELAPSED queries. Results are
+// read a few frames later, once available, so timing never stalls the
+// pipeline; a frame whose query slot is still busy goes untimed. Only one
+// timer may be running at a time (queries of one target cannot nest).
+struct GpuTimer {
+    static constexpr int LATENCY = 4; // Query slots in flight
+
+    void init();
+    void cleanup();
+    void begin();
+    void end();
+    void collect(bool wait = false); // Reads finished queries; end() calls it too
+
+    double averageMs() const { return samples ? totalMs / samples : 0.0; }
+    void reset() { totalMs = 0.0; samples = 0; }
+    uint64_t sampleCount() const { return samples; }
+
+private:
+    unsigned int queries[LATENCY] = {};
+    int next = 0;     // Slot of the next begin()
+    int pending = 0;  // Ended, result not read yet
+    bool running = false;
+    double totalMs = 0.0;
+    uint64_t samples = 0;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "grid.hpp"
+#include <iostream>
+#include "../shader/program_cache.hpp"
+
+namespace {
+
+// Fullscreen triangle from gl_VertexID; each corner carries its view ray as
+// points on the near and far planes
+const char* gridVertexSource =
+    "#version 330 core\n"
+    "uniform mat4 inverseViewProjection;\n"
+    "out vec3 nearPoint;\n"
+    "out vec3 farPoint;\n"
+    "vec3 unproject(vec2 ndc, float z) {\n"
+    "    vec4 p = inverseViewProjection * vec4(ndc, z, 1.0);\n"
+    "    return p.xyz / p.w;\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;\n"
+    "    nearPoint = unproject(ndc, -1.0);\n"
+    "    farPoint = unproject(ndc, 1.0);\n"
+    "    gl_Position = vec4(ndc, 0.0, 1.0);\n"
+    "}\n";
+
+const char* gridFragmentSource =
+    "#version 330 core\n"
+    "in vec3 nearPoint;\n"
+    "in vec3 farPoint;\n"
+    "uniform mat4 viewProjection;\n"
+    "uniform vec3 eye;\n"
+    "uniform vec4 grid;\n" // height, cell size, cells per major line, fade distance
+    "out vec4 FragColor;\n"
+    // Coverage of the nearest line, about one pixel wide at any distance
+    "float lines(vec2 coord) {\n"
+    "    vec2 width = fwidth(coord);\n"
+    "    vec2 g = abs(fract(coord - 0.5) - 0.5) / width;\n"
+    "    return 1.0 - min(min(g.x, g.y), 1.0);\n"
+    "}\n"
+    "void main() {\n"
+    "    float dy = farPoint.y - nearPoint.y;\n"
+    "    if (abs(dy) < 1e-6) discard;\n"
+    "    float t = (grid.x - nearPoint.y) / dy;\n"
+    "    if (t <= 0.0 || t > 1.0) discard;\n"
+    "    vec3 p = nearPoint + t * (farPoint - nearPoint);\n"
+    "    vec4 clip = viewProjection * vec4(p, 1.0);\n"
+    "    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;\n"
+    "    vec2 coord = p.xz / grid.y;\n"
+    "    float minor = lines(coord);\n"
+    "    float major = lines(coord / grid.z);\n"
+    "    vec3 color = mix(vec3(0.6), vec3(1.0), major);\n"
+    "    vec2 axisWidth = fwidth(p.xz);\n"
+    "    if (abs(p.x) < axisWidth.x) color = vec3(0.25, 0.25, 1.0);\n"
+    "    if (abs(p.z) < axisWidth.y) color = vec3(1.0, 0.25, 0.25);\n"
+    "    float fade = 1.0 - smoothstep(0.0, grid.w, distance(eye, p));\n"
+    "    float alpha = max(minor * 0.5, major) * fade;\n"
+    "    if (alpha < 0.004) discard;\n"
+    "    FragColor = vec4(color, alpha);\n"
+    "}\n";
+
+} // namespace
+
+bool GridPass::init() {
+    // Uniforms are resolved once the program cache has the program linked
+    programCache().submit(gridVertexSource, gridFragmentSource, "Grid", [this](unsigned int linked) {
+        program = linked;
+        if (!program) return;
+        uniformInverseViewProjection = glGetUniformLocation(program, "inverseViewProjection");
+        uniformViewProjection = glGetUniformLocation(program, "viewProjection");
+        uniformEye = glGetUniformLocation(program, "eye");
+        uniformGrid = glGetUniformLocation(program, "grid");
+    });
+    glGenVertexArrays(1, &emptyVAO);
+    return true;
+}
+
+void GridPass::cleanup() {
+    if (program) glDeleteProgram(program);
+    if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+    program = emptyVAO = 0;
+}
+
+void GridPass::render(const mat4& view, const mat4& projection, vec3 eye) const {
+    if (!program) return;
+    mat4 viewProjection = projection * view;
+    mat4 inverseViewProjection;
+    if (!inverse(viewProjection, inverseViewProjection)) return;
+
+    glUseProgram(program);
+    glUniformMatrix4fv(uniformInverseViewProjection, 1, GL_FALSE, inverseViewProjection.m);
+    glUniformMatrix4fv(uniformViewProjection, 1, GL_FALSE, viewProjection.m);
+    glUniform3f(uniformEye, eye.x, eye.y, eye.z);
+    glUniform4f(uniformGrid, settings.height, settings.cellSize, static_cast<float>(settings.majorEvery), settings.fadeDistance);
+
+    // Depth tested against the opaque scene but not written; the lines are translucent
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
@@ -0,0 +1,32 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <glad/glad.h>
+#include "../math/math.hpp"
+
+struct GridSettings {
+    float height = -1.0f;        // World y of the plane
+    float cellSize = 1.0f;       // Minor line spacing
+    int majorEvery = 10;         // Cells per major line
+    float fadeDistance = 150.0f; // Lines fade out toward this distance from the eye
+};
+
+// Infinite ground grid drawn analytically: one fullscreen triangle, with each
+// pixel's view ray intersected with the plane in the fragment shader. Lines
+// are antialiased from screen-space derivatives and depth is written from the
+// hit point, so the cost is a single pass however far the grid extends.
+// Drawn after opaque geometry, alpha blended.
+struct GridPass {
+    GridSettings settings;
+
+    bool init();
+    void cleanup();
+    void render(const mat4& view, const mat4& projection, vec3 eye) const;
+
+private:
+    unsigned int program = 0;
+    unsigned int emptyVAO = 0; // Core profile needs a bound VAO even without attributes
+    int uniformInverseViewProjection = -1, uniformViewProjection = -1, uniformEye = -1, uniformGrid = -1;
+};
+
+#endif
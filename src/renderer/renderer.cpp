@@ -1,41 +1,164 @@
 #include "renderer.hpp"
+#include "../memory/alloc_tracker.hpp"
+#include "../shader/shader_library.hpp"
 #include <cmath>
 
+namespace {
+
+const char* const gbufferFragmentPath = "shaders/gbuffer.frag";
+const char* const deferredVertexPath = "shaders/deferred.vert";
+const char* const deferredFragmentPath = "shaders/deferred.frag";
+
+} // namespace
+
 void Renderer::initRenderer() {
-    shaderProgram = initLightingShader();
+    AllocTagScope tag(AllocTag::Renderer);
+    initLightingShader(shaderProgram);
+    shaderLibrary().prewarm(lightingVertexPath, gbufferFragmentPath, 0,
+                            [this](unsigned int program) { gbufferProgram = program; });
+    shaderLibrary().prewarm(deferredVertexPath, deferredFragmentPath, SHADER_SHADOWS,
+                            [this](unsigned int program) { deferredProgram = program; });
+    shaderLibrary().prewarm(depthOnlyVertexPath, depthOnlyFragmentPath, 0,
+                            [this](unsigned int program) { depthProgram = program; });
+    grid.init();
+    lightBuffers.init();
+    shadows.init();
+    objectTimer.init();
+    shadowTimer.init();
+    glGenVertexArrays(1, &emptyVAO);
     glEnable(GL_DEPTH_TEST);
+}
 
-    // Projection matrix (FOV 45°, near 0.1, far 10)
-    float fov = 45.0f * M_PI / 180.0f;
-    projection[0] = 1.0f / tanf(fov / 2.0f) * (600.0f / 800.0f); // Aspect ratio HEIGHT/WIDTH
-    projection[1] = 0.0f; projection[2] = 0.0f; projection[3] = 0.0f;
-    projection[4] = 0.0f;
-    projection[5] = 1.0f / tanf(fov / 2.0f);
-    projection[6] = 0.0f; projection[7] = 0.0f;
-    projection[8] = 0.0f; projection[9] = 0.0f;
-    projection[10] = -(10.0f + 0.1f) / (10.0f - 0.1f);
-    projection[11] = -1.0f;
-    projection[12] = 0.0f; projection[13] = 0.0f;
-    projection[14] = -2.0f * 10.0f * 0.1f / (10.0f - 0.1f);
-    projection[15] = 0.0f;
-}
-
-void Renderer::render(const Scene& scene, const Camera& camera, float deltaTime) {
+void Renderer::render(const Scene& scene, const RenderPacket& packet) {
+    AllocTagScope tag(AllocTag::Renderer);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    lightBuffers.upload(packet.lights);
+
+    shadowTimer.begin();
+    shadows.render(packet);
+    shadowTimer.end();
+
+    objectTimer.begin();
+    if (shading == ShadingPath::Deferred && gbufferProgram && deferredProgram) {
+        renderDeferred(packet);
+    } else {
+        renderForward(packet);
+    }
+    objectTimer.end();
+
+    vec3 eye = {packet.cameraPos[0], packet.cameraPos[1], packet.cameraPos[2]};
+    if (scene.terrain && packet.terrainChunkCount > 0) {
+        scene.terrain->render(packet.view, packet.projection, eye, packet.sun, packet.terrainChunks, packet.terrainChunkCount);
+    }
+
+    grid.render(packet.view, packet.projection, eye);
+}
+
+void Renderer::cleanupRenderer() {
+    shaderLibrary().clear(); // Owns the object programs
+    shaderProgram = gbufferProgram = deferredProgram = depthProgram = 0;
+    grid.cleanup();
+    lightBuffers.cleanup();
+    gbuffer.cleanup();
+    shadows.cleanup();
+    objectTimer.cleanup();
+    shadowTimer.cleanup();
+    if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+    emptyVAO = 0;
+}
+
+void Renderer::renderForward(const RenderPacket& packet) {
+    bool prepassed = beginDepthPrepass(packet);
     glUseProgram(shaderProgram);
-    setupLighting(shaderProgram);
+    setupLighting(shaderProgram, packet.sun);
+    lightBuffers.bind(shaderProgram);
+    shadows.bind(shaderProgram, packet.shadows);
+    drawObjects(shaderProgram, packet);
+    if (prepassed) endDepthPrepass();
+}
+
+void Renderer::renderDeferred(const RenderPacket& packet) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!gbuffer.resize(viewport[2], viewport[3])) {
+        renderForward(packet);
+        return;
+    }
+
+    // Geometry pass: albedo, packed normal and depth, no lighting
+    glBindFramebuffer(GL_FRAMEBUFFER, gbuffer.fbo);
+    glViewport(0, 0, gbuffer.width, gbuffer.height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    bool prepassed = beginDepthPrepass(packet);
+    glUseProgram(gbufferProgram);
+    drawObjects(gbufferProgram, packet);
+    if (prepassed) endDepthPrepass();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
-    float view[16];
-    camera.getViewMatrix(view);
+    // Lighting pass: one fullscreen triangle; it also copies the G-buffer's
+    // depth out so the forward passes after it are occluded correctly
+    mat4 viewProjection = packet.projection * packet.view;
+    mat4 inverseViewProjection;
+    if (!inverse(viewProjection, inverseViewProjection)) return;
+    glUseProgram(deferredProgram);
+    setupLighting(deferredProgram, packet.sun);
+    lightBuffers.bind(deferredProgram);
+    shadows.bind(deferredProgram, packet.shadows);
+    gbuffer.bindTextures();
+    glUniform1i(glGetUniformLocation(deferredProgram, "gAlbedo"), GBuffer::FIRST_UNIT);
+    glUniform1i(glGetUniformLocation(deferredProgram, "gNormal"), GBuffer::FIRST_UNIT + 1);
+    glUniform1i(glGetUniformLocation(deferredProgram, "gDepth"), GBuffer::FIRST_UNIT + 2);
+    glUniformMatrix4fv(glGetUniformLocation(deferredProgram, "viewProjection"), 1, GL_FALSE, viewProjection.m);
+    glUniformMatrix4fv(glGetUniformLocation(deferredProgram, "inverseViewProjection"), 1, GL_FALSE, inverseViewProjection.m);
+    glDepthFunc(GL_ALWAYS);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+}
 
-    // Floor (white wireframe)
-    float floorModel[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, floorModel);
-    glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), 1.0f, 1.0f, 1.0f);
-    glBindVertexArray(scene.floorVAO);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glDrawElements(GL_TRIANGLES, 600, GL_UNSIGNED_INT, 0);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+// Objects, as snapshotted by the update thread
+void Renderer::drawObjects(unsigned int program, const RenderPacket& packet) {
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, packet.view.m);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, packet.projection.m);
+    int modelLoc = glGetUniformLocation(program, "model");
+    int normalLoc = glGetUniformLocation(program, "normalMatrix");
+    glUniform3f(glGetUniformLocation(program, "objectColor"), 0.8f, 0.8f, 0.8f);
+    for (size_t i = 0; i < packet.drawCount; i++) {
+        const DrawItem& draw = packet.draws[i];
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, draw.model.m);
+        glUniformMatrix3fv(normalLoc, 1, GL_FALSE, draw.normal.m);
+        glBindVertexArray(draw.VAO);
+        glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_INT, (void*)(draw.indexOffset * sizeof(unsigned int)));
+    }
+    glBindVertexArray(0);
+}
 
+// Position-only draws into the bound framebuffer's depth, no color
+bool Renderer::beginDepthPrepass(const RenderPacket& packet) {
+    if (!depthPrepass || !depthProgram || packet.drawCount == 0) return false;
+    glUseProgram(depthProgram);
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "view"), 1, GL_FALSE, packet.view.m);
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "projection"), 1, GL_FALSE, packet.projection.m);
+    int modelLoc = glGetUniformLocation(depthProgram, "model");
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    for (size_t i = 0; i < packet.drawCount; i++) {
+        const DrawItem& draw = packet.draws[i];
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, draw.model.m);
+        glBindVertexArray(draw.depthVAO);
+        glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_INT, (void*)(draw.indexOffset * sizeof(unsigned int)));
+    }
     glBindVertexArray(0);
-}
\ No newline at end of file
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // Depth is final; the shading pass only has to match it
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+    return true;
+}
+
+void Renderer::endDepthPrepass() {
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
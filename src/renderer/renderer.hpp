@@ -5,13 +5,51 @@
 #include "../scene/scene.hpp"
 #include "../camera/camera.hpp"
 #include "../lighting/lighting.hpp"
+#include "../lighting/light_buffers.hpp"
+#include "../frame/frame_pipeline.hpp"
+#include "../math/math.hpp"
+#include "gbuffer.hpp"
+#include "gpu_timer.hpp"
+#include "grid.hpp"
+#include "shadow_pass.hpp"
+
+// How objects are lit; switchable between frames. Forward shades every
+// fragment drawn, so overdraw multiplies the light loop. Deferred writes
+// albedo/normal/depth first and then lights each pixel once in a fullscreen
+// pass over the same cluster lists. Terrain and grid stay forward either way.
+enum class ShadingPath {
+    Forward,
+    Deferred
+};
 
 struct Renderer {
-    unsigned int shaderProgram;
-    float projection[16];
+    ShadingPath shading = ShadingPath::Forward;
+    // Lay down object depth first with the position-only shader, then shade
+    // with GL_EQUAL so each pixel runs the lighting shader at most once
+    bool depthPrepass = true;
+    unsigned int shaderProgram = 0;   // Forward lighting, with shadows
+    unsigned int gbufferProgram = 0;  // Deferred geometry pass
+    unsigned int deferredProgram = 0; // Deferred lighting pass, with shadows
+    unsigned int depthProgram = 0;    // Depth pre-pass
+    GridPass grid; // Ground grid, drawn last
+    LightBuffers lightBuffers; // The packet's clustered point/spot lights
+    GBuffer gbuffer;           // Sized to the viewport on first deferred frame
+    ShadowPass shadows;        // Sun cascades, rendered before the objects
+    GpuTimer objectTimer;      // Object drawing and lighting, either path, pre-pass included
+    GpuTimer shadowTimer;      // Shadow depth pass
 
     void initRenderer();
-    void render(const Scene& scene, const Camera& camera, float deltaTime);
+    void render(const Scene& scene, const RenderPacket& packet);
+    void cleanupRenderer();
+
+private:
+    unsigned int emptyVAO = 0; // For the fullscreen lighting triangle
+
+    void renderForward(const RenderPacket& packet);
+    void renderDeferred(const RenderPacket& packet);
+    void drawObjects(unsigned int program, const RenderPacket& packet);
+    bool beginDepthPrepass(const RenderPacket& packet); // True if depth is laid down; switches to GL_EQUAL
+    void endDepthPrepass();
 };
 
-#endif
\ No newline at end of file
+#endif
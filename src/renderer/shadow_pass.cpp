@@ -0,0 +1,126 @@
+#include "shadow_pass.hpp"
+#include "../shader/shader_library.hpp"
+#include <iostream>
+
+const char* const depthOnlyVertexPath = "shaders/depth_only.vert";
+const char* const depthOnlyFragmentPath = "shaders/depth_only.frag";
+
+void ShadowPass::init() {
+    shaderLibrary().prewarm(depthOnlyVertexPath, depthOnlyFragmentPath, 0, [this](unsigned int linked) { program = linked; });
+    glGenFramebuffers(1, &fbo);
+}
+
+void ShadowPass::cleanup() {
+    program = 0; // Owned by the shader library
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (depthArray) glDeleteTextures(1, &depthArray);
+    fbo = depthArray = 0;
+    resolution = layers = 0;
+    rendered = false;
+}
+
+bool ShadowPass::resize(int newResolution, int newLayers) {
+    if (depthArray && newResolution == resolution && newLayers == layers) return true;
+    if (depthArray) glDeleteTextures(1, &depthArray);
+    resolution = newResolution;
+    layers = newLayers;
+
+    // Linear filtering with compare mode gives 2x2 PCF per lookup
+    glGenTextures(1, &depthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, layers, 0,
+                 GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float border[4] = {1.0f, 1.0f, 1.0f, 1.0f}; // Outside the map is lit
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ShadowPass: framebuffer incomplete (0x" << std::hex << status << std::dec << ")" << std::endl;
+        glDeleteTextures(1, &depthArray);
+        depthArray = 0;
+        resolution = layers = 0;
+        return false;
+    }
+    return true;
+}
+
+void ShadowPass::render(const RenderPacket& packet) {
+    const ShadowCascades& cascades = packet.shadows;
+    rendered = false;
+    if (!program || cascades.count == 0) return;
+    if (!resize(cascades.settings.resolution, cascades.count)) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, resolution, resolution);
+    glUseProgram(program);
+    int modelLoc = glGetUniformLocation(program, "model");
+    int projectionLoc = glGetUniformLocation(program, "projection");
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, mat4Identity().m);
+
+    // Depth clamp flattens casters in front of a cascade onto its near plane
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(cascades.settings.slopeBias, cascades.settings.constantBias);
+    for (int c = 0; c < cascades.count; c++) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, c);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, cascades.viewProjection[c].m);
+        uint8_t bit = static_cast<uint8_t>(1u << c);
+        for (size_t i = 0; i < packet.drawCount; i++) {
+            const DrawItem& draw = packet.draws[i];
+            if (!(draw.cascadeMask & bit)) continue;
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, draw.model.m);
+            glBindVertexArray(draw.depthVAO);
+            glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_INT, (void*)(draw.indexOffset * sizeof(unsigned int)));
+        }
+    }
+    glBindVertexArray(0);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    rendered = true;
+}
+
+void ShadowPass::bind(unsigned int target, const ShadowCascades& cascades) const {
+    int count = rendered ? cascades.count : 0;
+    glUniform1i(glGetUniformLocation(target, "cascadeCount"), count);
+    if (count == 0) return;
+
+    // Clip space to [0, 1] texture coordinates and depth
+    mat4 bias = mat4Identity();
+    bias.m[0] = bias.m[5] = bias.m[10] = 0.5f;
+    bias.m[12] = bias.m[13] = bias.m[14] = 0.5f;
+    mat4 matrices[MAX_CASCADES];
+    float splits[MAX_CASCADES] = {};
+    float texelSizes[MAX_CASCADES] = {};
+    for (int c = 0; c < count; c++) {
+        matrices[c] = bias * cascades.viewProjection[c];
+        splits[c] = cascades.splitDepth[c];
+        texelSizes[c] = cascades.texelSize[c];
+    }
+
+    glActiveTexture(GL_TEXTURE0 + UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(target, "shadowMap"), UNIT);
+    glUniformMatrix4fv(glGetUniformLocation(target, "shadowMatrices"), count, GL_FALSE, matrices[0].m);
+    glUniform4fv(glGetUniformLocation(target, "cascadeSplits"), 1, splits);
+    glUniform4fv(glGetUniformLocation(target, "cascadeTexelSizes"), 1, texelSizes);
+    glUniform1i(glGetUniformLocation(target, "pcfRadius"), cascades.settings.pcfRadius);
+    glUniform1f(glGetUniformLocation(target, "normalBias"), cascades.settings.normalBias);
+}
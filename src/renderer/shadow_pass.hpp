@@ -0,0 +1,37 @@
+#ifndef SHADOW_PASS_HPP
+#define SHADOW_PASS_HPP
+
+#include <glad/glad.h>
+#include "../frame/frame_pipeline.hpp"
+
+// Position-only depth shader (model, view, projection; attribute 0), shared
+// by the shadow pass and the depth pre-pass
+extern const char* const depthOnlyVertexPath;
+extern const char* const depthOnlyFragmentPath;
+
+// Renders a packet's sun cascades into one layer each of a depth texture
+// array, drawing only the objects whose cascadeMask has that cascade's bit.
+// The array is reallocated when ShadowSettings' resolution or cascade count
+// changes. Lighting shaders built with SHADER_SHADOWS sample it through
+// include/shadows.glsl.
+struct ShadowPass {
+    static constexpr int UNIT = 7; // Texture unit of the shadow map
+
+    void init();
+    void cleanup();
+    void render(const RenderPacket& packet);
+    // Sets the shadow uniforms of a SHADER_SHADOWS program; shadows are off
+    // when this frame has no cascades or no depth program yet
+    void bind(unsigned int program, const ShadowCascades& cascades) const;
+
+private:
+    unsigned int program = 0; // Depth only
+    unsigned int fbo = 0;
+    unsigned int depthArray = 0;
+    int resolution = 0, layers = 0;
+    bool rendered = false; // The array holds this frame's cascades
+
+    bool resize(int newResolution, int newLayers);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include "../camera/camera.hpp"
+#include "../math/math.hpp"
+#include "transforms.hpp"
+
+// ECS components shared by the scene, update and render code. Renderable
+// meshes use Object (scene.hpp) as their component.
+
+struct TransformComponent {
+    TransformHandle handle; // Into Scene::transforms
+};
+
+enum class LightType {
+    Directional,
+    Point,
+    Spot
+};
+
+struct LightComponent {
+    LightType type = LightType::Directional;
+    vec3 color = {1.0f, 1.0f, 1.0f};
+    float intensity = 1.0f;
+    vec3 direction = {0.0f, -1.0f, -0.5f}; // Directional and spot
+    float range = 10.0f;                   // Point and spot; position from TransformComponent
+    float innerCone = 0.95f;               // Spot cone cosines
+    float outerCone = 0.9f;
+};
+
+struct CameraComponent {
+    Camera* camera;                        // Simulated by FramePipeline on the update thread
+    float fovY = 45.0f * M_PI / 180.0f;
+    float aspect = 800.0f / 600.0f;
+    float zNear = 0.1f;
+    float zFar = 10.0f;
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "lod.hpp"
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+// Symmetric 4x4 error quadric, upper triangle: 00 01 02 03 11 12 13 22 23 33
+struct Quadric {
+    double a[10] = {};
+
+    void addPlane(double nx, double ny, double nz, double d, double weight) {
+        a[0] += weight * nx * nx; a[1] += weight * nx * ny; a[2] += weight * nx * nz; a[3] += weight * nx * d;
+        a[4] += weight * ny * ny; a[5] += weight * ny * nz; a[6] += weight * ny * d;
+        a[7] += weight * nz * nz; a[8] += weight * nz * d;
+        a[9] += weight * d * d;
+    }
+    void add(const Quadric& q) {
+        for (int i = 0; i < 10; i++) a[i] += q.a[i];
+    }
+    double evaluate(const float* p) const {
+        double x = p[0], y = p[1], z = p[2];
+        return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x +
+               a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y +
+               a[7] * z * z + 2 * a[8] * z + a[9];
+    }
+};
+
+struct Collapse {
+    double cost;
+    uint32_t from, to;
+    uint32_t fromVersion, toVersion;
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+struct PositionKey {
+    uint32_t bits[3];
+    bool operator==(const PositionKey& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+};
+
+struct PositionHash {
+    size_t operator()(const PositionKey& key) const {
+        return (key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u);
+    }
+};
+
+void triangleNormal(const float* p0, const float* p1, const float* p2, double n[3]) {
+    double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+} // namespace
+
+void simplifyMesh(const float* vertices, size_t vertexCount, int stride, const unsigned int* indices,
+                  size_t indexCount, size_t targetIndexCount, std::vector<unsigned int>& out) {
+    // Weld vertices that share a position (the OBJ loader emits one per corner)
+    std::unordered_map<PositionKey, uint32_t, PositionHash> weldMap;
+    std::vector<uint32_t> weldOf(vertexCount);
+    std::vector<uint32_t> original;  // First original vertex of each welded one
+    std::vector<float> positions;
+    for (size_t v = 0; v < vertexCount; v++) {
+        PositionKey key;
+        std::memcpy(key.bits, vertices + v * stride, sizeof(key.bits));
+        auto inserted = weldMap.emplace(key, static_cast<uint32_t>(original.size()));
+        if (inserted.second) {
+            original.push_back(static_cast<uint32_t>(v));
+            positions.insert(positions.end(), vertices + v * stride, vertices + v * stride + 3);
+        }
+        weldOf[v] = inserted.first->second;
+    }
+    size_t welded = original.size();
+
+    // A welded vertex is a seam when its copies differ in normal or UV (hard
+    // edges, UV seams); seams are never moved, so their attributes survive
+    std::vector<bool> seam(welded, false);
+    size_t vertexBytes = stride * sizeof(float);
+    for (size_t v = 0; v < vertexCount; v++) {
+        uint32_t w = weldOf[v];
+        if (!seam[w] && std::memcmp(vertices + v * stride, vertices + original[w] * stride, vertexBytes) != 0) {
+            seam[w] = true;
+        }
+    }
+
+    // Topology runs on welded ids; each corner keeps its own vertex for output
+    std::vector<uint32_t> corners;
+    std::vector<uint32_t> cornerVertex;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = weldOf[indices[i]], b = weldOf[indices[i + 1]], c = weldOf[indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+        corners.push_back(a);
+        corners.push_back(b);
+        corners.push_back(c);
+        cornerVertex.insert(cornerVertex.end(), indices + i, indices + i + 3);
+    }
+    size_t triangleCount = corners.size() / 3;
+    std::vector<bool> triangleAlive(triangleCount, true);
+    std::vector<std::vector<uint32_t>> vertexTriangles(welded);
+    std::vector<Quadric> quadrics(welded);
+
+    // Plane quadrics, area weighted; open edges get a perpendicular plane so
+    // borders hold their shape
+    std::unordered_map<uint64_t, int> edgeUses;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* tri = &corners[t * 3];
+        double n[3];
+        triangleNormal(&positions[tri[0] * 3], &positions[tri[1] * 3], &positions[tri[2] * 3], n);
+        double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int k = 0; k < 3; k++) {
+            vertexTriangles[tri[k]].push_back(static_cast<uint32_t>(t));
+            uint32_t a = tri[k], b = tri[(k + 1) % 3];
+            edgeUses[a < b ? (uint64_t(a) << 32 | b) : (uint64_t(b) << 32 | a)]++;
+        }
+        if (area == 0.0) continue;
+        for (int i = 0; i < 3; i++) n[i] /= area;
+        const float* p = &positions[tri[0] * 3];
+        double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+        for (int k = 0; k < 3; k++) quadrics[tri[k]].addPlane(n[0], n[1], n[2], d, area * 0.5);
+    }
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* tri = &corners[t * 3];
+        double n[3];
+        triangleNormal(&positions[tri[0] * 3], &positions[tri[1] * 3], &positions[tri[2] * 3], n);
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = tri[k], b = tri[(k + 1) % 3];
+            if (edgeUses[a < b ? (uint64_t(a) << 32 | b) : (uint64_t(b) << 32 | a)] != 1) continue;
+            const float* pa = &positions[a * 3];
+            const float* pb = &positions[b * 3];
+            double e[3] = {double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2]};
+            double m[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+            double len = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+            if (len == 0.0) continue;
+            for (int i = 0; i < 3; i++) m[i] /= len;
+            double d = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+            double weight = 10.0 * (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+            quadrics[a].addPlane(m[0], m[1], m[2], d, weight);
+            quadrics[b].addPlane(m[0], m[1], m[2], d, weight);
+        }
+    }
+
+    std::vector<uint32_t> version(welded, 0);
+    std::vector<bool> removed(welded, false);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+
+    // Cheaper direction of collapsing the edge a-b onto one of its endpoints
+    auto pushEdge = [&](uint32_t a, uint32_t b) {
+        Quadric q = quadrics[a];
+        q.add(quadrics[b]);
+        if (seam[a] && seam[b]) return;
+        double toB = seam[a] ? HUGE_VAL : q.evaluate(&positions[b * 3]);
+        double toA = seam[b] ? HUGE_VAL : q.evaluate(&positions[a * 3]);
+        if (toB <= toA) heap.push({toB, a, b, version[a], version[b]});
+        else heap.push({toA, b, a, version[b], version[a]});
+    };
+
+    // The vertex that triangles moving onto `to` should use: the `to` corner of
+    // a triangle on the collapsing edge. `from` is not a seam, so its fan lies
+    // on one side of any seam through `to` and that corner's attributes match.
+    auto targetVertex = [&](uint32_t from, uint32_t to, uint32_t& vertex) {
+        for (uint32_t t : vertexTriangles[from]) {
+            if (!triangleAlive[t]) continue;
+            for (int k = 0; k < 3; k++) {
+                if (corners[t * 3 + k] != to) continue;
+                vertex = cornerVertex[t * 3 + k];
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Moving `from` onto `to` must not turn any surviving triangle over
+    auto flips = [&](uint32_t from, uint32_t to) {
+        for (uint32_t t : vertexTriangles[from]) {
+            if (!triangleAlive[t]) continue;
+            const uint32_t* tri = &corners[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) continue;
+            const float* before[3];
+            const float* after[3];
+            for (int k = 0; k < 3; k++) {
+                before[k] = &positions[tri[k] * 3];
+                after[k] = tri[k] == from ? &positions[to * 3] : before[k];
+            }
+            double n0[3], n1[3];
+            triangleNormal(before[0], before[1], before[2], n0);
+            triangleNormal(after[0], after[1], after[2], n1);
+            double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+            double len = std::sqrt((n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]) * (n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]));
+            if (len == 0.0 || dot < 0.2 * len) return true;
+        }
+        return false;
+    };
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) pushEdge(corners[t * 3 + k], corners[t * 3 + (k + 1) % 3]);
+    }
+
+    size_t remaining = triangleCount;
+    size_t target = targetIndexCount / 3;
+    while (remaining > target && !heap.empty()) {
+        Collapse c = heap.top();
+        heap.pop();
+        if (removed[c.from] || removed[c.to]) continue;
+        if (version[c.from] != c.fromVersion || version[c.to] != c.toVersion) continue;
+        if (seam[c.from]) continue;
+        uint32_t toVertex;
+        if (!targetVertex(c.from, c.to, toVertex)) continue;
+        if (flips(c.from, c.to)) continue;
+
+        removed[c.from] = true;
+        quadrics[c.to].add(quadrics[c.from]);
+        version[c.to]++;
+        for (uint32_t t : vertexTriangles[c.from]) {
+            if (!triangleAlive[t]) continue;
+            uint32_t* tri = &corners[t * 3];
+            bool hasTo = tri[0] == c.to || tri[1] == c.to || tri[2] == c.to;
+            if (hasTo) {
+                triangleAlive[t] = false;
+                remaining--;
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] != c.from) continue;
+                tri[k] = c.to;
+                cornerVertex[t * 3 + k] = toVertex;
+            }
+            vertexTriangles[c.to].push_back(t);
+        }
+
+        // Neighbours' costs changed with the merged quadric
+        for (uint32_t t : vertexTriangles[c.to]) {
+            if (!triangleAlive[t]) continue;
+            for (int k = 0; k < 3; k++) {
+                uint32_t other = corners[t * 3 + k];
+                if (other != c.to) pushEdge(c.to, other);
+            }
+        }
+    }
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (!triangleAlive[t]) continue;
+        out.insert(out.end(), &cornerVertex[t * 3], &cornerVertex[t * 3] + 3);
+    }
+}
+
+int selectLod(int currentLod, int lodCount, float screenSize, const LodSettings& settings) {
+    int lod = currentLod < lodCount ? currentLod : lodCount - 1;
+    while (lod + 1 < lodCount && screenSize < settings.screenSize[lod + 1] * (1.0f - settings.hysteresis)) lod++;
+    while (lod > 0 && screenSize > settings.screenSize[lod] * (1.0f + settings.hysteresis)) lod--;
+    return lod < 0 ? 0 : lod;
+}
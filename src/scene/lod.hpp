@@ -0,0 +1,38 @@
+#ifndef LOD_HPP
+#define LOD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr int MAX_LODS = 4;
+
+// One level of detail: a range of the mesh's shared index buffer
+struct MeshLod {
+    int indexOffset = 0; // In indices
+    int indexCount = 0;
+};
+
+// Runtime LOD choice by projected size: the bounding sphere's radius over the
+// half-height of the view at its distance (1 = fills the screen vertically).
+struct LodSettings {
+    float screenSize[MAX_LODS] = {0.0f, 0.25f, 0.12f, 0.05f}; // LOD i below screenSize[i]
+    float hysteresis = 0.15f; // Fraction a size must overshoot a threshold to switch
+};
+
+// Quadric-error edge-collapse simplification. Vertices sharing a position are
+// welded for topology; collapses move one endpoint onto the other, and the
+// result indexes the original vertex buffer. Every corner keeps its own vertex
+// (normal, UV) unless its position was collapsed, in which case it takes the
+// target's vertex from the same side of any seam. Positions whose copies
+// differ in attributes (hard edges, UV seams) are never moved. Stops at
+// targetIndexCount or when no collapse is left that would not flip a
+// triangle. Appends to out.
+void simplifyMesh(const float* vertices, size_t vertexCount, int stride, const unsigned int* indices,
+                  size_t indexCount, size_t targetIndexCount, std::vector<unsigned int>& out);
+
+// Picks a LOD for a screen size, only leaving the current one once the size
+// is past the threshold by the hysteresis margin.
+int selectLod(int currentLod, int lodCount, float screenSize, const LodSettings& settings);
+
+#endif
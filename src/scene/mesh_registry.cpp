@@ -0,0 +1,186 @@
+#include "mesh_registry.hpp"
+#include <glad/glad.h>
+#include <filesystem>
+#include <iostream>
+
+std::string MeshRegistry::canonicalPath(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    return error ? path : canonical.string();
+}
+
+uint64_t MeshRegistry::hashContents(const std::string& contents) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : contents) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace {
+
+void deleteNames(unsigned int& VAO, unsigned int& depthVAO, unsigned int& VBO, unsigned int& positionVBO,
+                 unsigned int& EBO) {
+    if (VAO) glDeleteVertexArrays(1, &VAO);
+    if (depthVAO) glDeleteVertexArrays(1, &depthVAO);
+    if (VBO) glDeleteBuffers(1, &VBO);
+    if (positionVBO) glDeleteBuffers(1, &positionVBO);
+    if (EBO) glDeleteBuffers(1, &EBO);
+    VAO = depthVAO = VBO = positionVBO = EBO = 0;
+}
+
+} // namespace
+
+void MeshRegistry::deleteBuffers(Mesh& mesh) {
+    deleteNames(mesh.VAO, mesh.depthVAO, mesh.VBO, mesh.positionVBO, mesh.EBO);
+}
+
+size_t MeshRegistry::positionBytes(const Mesh& mesh) {
+    return mesh.vertices.size() / (mesh.hasTexCoords ? 8 : 6) * 3 * sizeof(float);
+}
+
+size_t MeshRegistry::uploadBytes(const Mesh& mesh) {
+    return mesh.vertices.size() * sizeof(float) + mesh.indices.size() * sizeof(unsigned int) + positionBytes(mesh);
+}
+
+void MeshRegistry::packPositions(const Mesh& mesh, float* positions) {
+    size_t stride = mesh.hasTexCoords ? 8 : 6;
+    size_t vertexCount = mesh.vertices.size() / stride;
+    for (size_t v = 0; v < vertexCount; v++) {
+        for (int k = 0; k < 3; k++) positions[v * 3 + k] = mesh.vertices[v * stride + k];
+    }
+}
+
+float* MeshRegistry::packPositions(const Mesh& mesh, Arena& arena, size_t& floatCount) {
+    floatCount = positionBytes(mesh) / sizeof(float);
+    float* positions = arena.allocateArray<float>(floatCount > 0 ? floatCount : 1);
+    packPositions(mesh, positions);
+    return positions;
+}
+
+MeshHandle MeshRegistry::findPath(const std::string& canonicalPath) const {
+    MeshHandle handle;
+    auto it = byPath.find(canonicalPath);
+    if (it != byPath.end()) {
+        handle.index = it->second;
+        handle.generation = entries[it->second].generation;
+    }
+    return handle;
+}
+
+MeshHandle MeshRegistry::findHash(uint64_t contentHash) const {
+    MeshHandle handle;
+    auto it = byHash.find(contentHash);
+    if (it != byHash.end()) {
+        handle.index = it->second;
+        handle.generation = entries[it->second].generation;
+    }
+    return handle;
+}
+
+MeshHandle MeshRegistry::insert(Mesh mesh, const std::string& canonicalPath, uint64_t contentHash) {
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(entries.size());
+        entries.emplace_back();
+    }
+
+    Entry& entry = entries[index];
+    entry.mesh = std::move(mesh);
+    entry.paths.assign(1, canonicalPath);
+    entry.hash = contentHash;
+    entry.refCount = 0;
+    entry.live = true;
+    byPath[canonicalPath] = index;
+    byHash[contentHash] = index;
+    return {index, entry.generation};
+}
+
+void MeshRegistry::addPath(MeshHandle handle, const std::string& canonicalPath) {
+    if (!valid(handle) || byPath.count(canonicalPath)) return;
+    entries[handle.index].paths.push_back(canonicalPath);
+    byPath[canonicalPath] = handle.index;
+}
+
+void MeshRegistry::acquire(MeshHandle handle) {
+    if (valid(handle)) entries[handle.index].refCount++;
+}
+
+void MeshRegistry::release(MeshHandle handle) {
+    if (!valid(handle)) return;
+    Entry& entry = entries[handle.index];
+    if (entry.refCount > 0 && --entry.refCount == 0) erase(handle.index);
+}
+
+bool MeshRegistry::valid(MeshHandle handle) const {
+    return handle.index < entries.size() && entries[handle.index].live &&
+           entries[handle.index].generation == handle.generation;
+}
+
+size_t MeshRegistry::cpuBytes(const Mesh& mesh) {
+    return mesh.vertices.capacity() * sizeof(float) + mesh.indices.capacity() * sizeof(unsigned int) +
+           mesh.positions.capacity() * sizeof(float);
+}
+
+size_t MeshRegistry::gpuBytes() const {
+    size_t total = 0;
+    for (const Entry& entry : entries) {
+        if (entry.live) total += entry.mesh.gpuBytes;
+    }
+    return total;
+}
+
+size_t MeshRegistry::cpuBytes() const {
+    size_t total = 0;
+    for (const Entry& entry : entries) {
+        if (entry.live) total += cpuBytes(entry.mesh);
+    }
+    return total;
+}
+
+void MeshRegistry::printReport() const {
+    for (const Entry& entry : entries) {
+        if (!entry.live) continue;
+        std::cout << entry.paths[0] << ": " << entry.refCount << " refs, "
+                  << entry.mesh.gpuBytes / 1024 << " KB GPU, " << cpuBytes(entry.mesh) / 1024 << " KB CPU";
+        if (entry.paths.size() > 1) std::cout << " (" << entry.paths.size() - 1 << " aliases)";
+        std::cout << std::endl;
+    }
+    std::cout << "meshes total: " << gpuBytes() / 1024 << " KB GPU, " << cpuBytes() / 1024 << " KB CPU" << std::endl;
+}
+
+void MeshRegistry::collectRetired(int framesInFlight) {
+    size_t kept = 0;
+    for (RetiredBuffers& buffers : retired) {
+        if (++buffers.syncs >= framesInFlight) {
+            deleteNames(buffers.VAO, buffers.depthVAO, buffers.VBO, buffers.positionVBO, buffers.EBO);
+        } else {
+            retired[kept++] = buffers;
+        }
+    }
+    retired.resize(kept);
+}
+
+void MeshRegistry::clear() {
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        if (entries[i].live) erase(i);
+    }
+    collectRetired(0);
+}
+
+void MeshRegistry::erase(uint32_t index) {
+    Entry& entry = entries[index];
+    const Mesh& mesh = entry.mesh;
+    retired.push_back({mesh.VAO, mesh.depthVAO, mesh.VBO, mesh.positionVBO, mesh.EBO});
+    entry.mesh = Mesh();
+    for (const std::string& path : entry.paths) byPath.erase(path);
+    entry.paths.clear();
+    byHash.erase(entry.hash);
+    entry.live = false;
+    entry.generation++;
+    freeIndices.push_back(index);
+}
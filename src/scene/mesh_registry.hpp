@@ -0,0 +1,97 @@
+#ifndef MESH_REGISTRY_HPP
+#define MESH_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../math/math.hpp"
+#include "../memory/arena.hpp"
+#include "lod.hpp"
+
+// Mesh asset shared by every Object that draws it
+struct Mesh {
+    std::vector<float> vertices;       // pos (3) + normal (3) per vertex; empty after upload unless Full
+    std::vector<unsigned int> indices; // All LODs back to back; after upload LOD 0 only (PositionsOnly) or empty (Release)
+    std::vector<float> positions;      // xyz per vertex, PositionsOnly
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int depthVAO = 0, positionVBO = 0; // Tightly packed xyz + the EBO, for depth-only passes
+    int vertexCount = 0;               // Valid after upload whatever the residency
+    int indexCount = 0;                // LOD 0
+    MeshLod lods[MAX_LODS];            // Ranges of the shared EBO, finest first
+    int lodCount = 1;
+    size_t gpuBytes = 0;               // VBO + EBO + position VBO
+    vec3 boundsCenter;                 // Local-space bounding sphere
+    float boundsRadius;
+    bool hasTexCoords;                 // Whether the OBJ has texture coords
+};
+
+struct MeshHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Uploaded meshes keyed by canonical path and by content hash, so a file is
+// loaded once however many times (or under however many names) it is added.
+// Reference counted: the last release retires the mesh's GL objects, which are
+// deleted by collectRetired() once no packet in flight can still draw them.
+// Render thread only.
+struct MeshRegistry {
+    static std::string canonicalPath(const std::string& path);
+    static uint64_t hashContents(const std::string& contents); // FNV-1a 64
+    static void deleteBuffers(Mesh& mesh);
+    // Sizes of the buffers made from vertices and indices as loaded: the
+    // position VBO alone, and VBO + EBO + position VBO
+    static size_t positionBytes(const Mesh& mesh);
+    static size_t uploadBytes(const Mesh& mesh);
+    // xyz of every interleaved vertex, positionBytes() worth, for the position
+    // VBO and PositionsOnly residency; floatCount = 3 per vertex
+    static void packPositions(const Mesh& mesh, float* positions);
+    static float* packPositions(const Mesh& mesh, Arena& arena, size_t& floatCount);
+
+    MeshHandle findPath(const std::string& canonicalPath) const;
+    MeshHandle findHash(uint64_t contentHash) const;
+    // Takes an uploaded mesh; it has no references until acquire()
+    MeshHandle insert(Mesh mesh, const std::string& canonicalPath, uint64_t contentHash);
+    void addPath(MeshHandle handle, const std::string& canonicalPath); // Same content, other name
+
+    void acquire(MeshHandle handle);
+    void release(MeshHandle handle);
+    bool valid(MeshHandle handle) const;
+    const Mesh& get(MeshHandle handle) const { return entries[handle.index].mesh; }
+
+    size_t gpuBytes() const;
+    size_t cpuBytes() const;
+    void printReport() const; // Per-asset references and memory to std::cout
+    // Once per FramePipeline::sync(): deletes GL objects retired at least
+    // framesInFlight syncs ago
+    void collectRetired(int framesInFlight);
+    void clear();             // Deletes every mesh and retired object regardless of references; no frames in flight
+
+private:
+    struct RetiredBuffers {
+        unsigned int VAO, depthVAO, VBO, positionVBO, EBO;
+        int syncs = 0;
+    };
+
+    struct Entry {
+        Mesh mesh;
+        std::vector<std::string> paths;
+        uint64_t hash = 0;
+        uint32_t refCount = 0;
+        uint32_t generation = 0;
+        bool live = false;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeIndices;
+    std::unordered_map<std::string, uint32_t> byPath;
+    std::unordered_map<uint64_t, uint32_t> byHash;
+    std::vector<RetiredBuffers> retired;
+
+    static size_t cpuBytes(const Mesh& mesh);
+    void erase(uint32_t index);
+};
+
+#endif
@@ -1,19 +1,51 @@
 #include "scene.hpp"
+#include "upload_thread.hpp"
+#include "../memory/alloc_tracker.hpp"
+#include "../memory/arena.hpp"
+#include <chrono>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
-bool Scene::loadObj(const std::string& filename, std::vector<float>& vertices, 
-                    std::vector<unsigned int>& indices, bool& hasTexCoords) {
-    std::ifstream file(filename);
+bool Scene::readFile(const std::string& filename, std::string& contents) {
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open " << filename << std::endl;
         return false;
     }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+void Scene::parseObj(const std::string& contents, std::vector<float>& vertices,
+                     std::vector<unsigned int>& indices, bool& hasTexCoords) {
+    // Count records up front so nothing grows by push_back reallocation
+    size_t positionCount = 0, normalCount = 0, texCoordCount = 0, faceCount = 0;
+    for (size_t i = 0; i + 1 < contents.size(); i++) {
+        if (i != 0 && contents[i - 1] != '\n') continue;
+        if (contents[i] == 'f' && contents[i + 1] == ' ') faceCount++;
+        if (contents[i] != 'v') continue;
+        if (contents[i + 1] == ' ') positionCount++;
+        else if (contents[i + 1] == 'n') normalCount++;
+        else if (contents[i + 1] == 't') texCoordCount++;
+    }
+
+    // Temporaries live in this thread's scratch arena
+    Arena& scratch = scratchArena();
+    ArenaScope scope(scratch);
+    ArenaVector<float> positions{ArenaAllocator<float>(scratch)};    // v: x, y, z
+    ArenaVector<float> normals{ArenaAllocator<float>(scratch)};      // vn: nx, ny, nz
+    ArenaVector<float> texCoords{ArenaAllocator<float>(scratch)};    // vt: u, v
+    positions.reserve(positionCount * 3);
+    normals.reserve(normalCount * 3);
+    texCoords.reserve(texCoordCount * 2);
+    vertices.reserve(faceCount * 3 * (texCoordCount > 0 ? 8 : 6));
+    indices.reserve(faceCount * 3);
 
-    std::vector<float> positions;    // v: x, y, z
-    std::vector<float> normals;      // vn: nx, ny, nz
-    std::vector<float> texCoords;    // vt: u, v
+    std::istringstream file(contents);
     std::string line;
     hasTexCoords = false;
 
@@ -75,103 +107,352 @@ bool Scene::loadObj(const std::string& filename, std::vector<float>& vertices,
             }
         }
     }
-    file.close();
-    return true;
 }
 
-void Scene::initFloor() {
-    int index = 0;
-    for (int z = 0; z <= 10; z++) {
-        for (int x = 0; x <= 10; x++) {
-            floorVertices[index++] = (x - 5.0f);
-            floorVertices[index++] = -1.0f; // Floor at y = -1
-            floorVertices[index++] = (z - 5.0f);
-            floorVertices[index++] = 0.0f;
-            floorVertices[index++] = 1.0f;
-            floorVertices[index++] = 0.0f;
-        }
+void Scene::computeBounds(Mesh& mesh) {
+    int stride = mesh.hasTexCoords ? 8 : 6;
+    vec3 lo = {0.0f, 0.0f, 0.0f}, hi = {0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i + 2 < mesh.vertices.size(); i += stride) {
+        vec3 p = {mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]};
+        if (i == 0) lo = hi = p;
+        lo = {std::fmin(lo.x, p.x), std::fmin(lo.y, p.y), std::fmin(lo.z, p.z)};
+        hi = {std::fmax(hi.x, p.x), std::fmax(hi.y, p.y), std::fmax(hi.z, p.z)};
     }
+    mesh.boundsCenter = (lo + hi) * 0.5f;
+    mesh.boundsRadius = length(hi - mesh.boundsCenter);
+}
 
-    index = 0;
-    for (int z = 0; z < 10; z++) {
-        for (int x = 0; x < 10; x++) {
-            int topLeft = z * 11 + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * 11 + x;
-            int bottomRight = bottomLeft + 1;
-            floorIndices[index++] = topLeft;
-            floorIndices[index++] = bottomLeft;
-            floorIndices[index++] = topRight;
-            floorIndices[index++] = topRight;
-            floorIndices[index++] = bottomLeft;
-            floorIndices[index++] = bottomRight;
-        }
+// LOD 1-3 at 50/25/12.5% of the triangles, each simplified from the one
+// before and appended to the index buffer. Stops early once the simplifier
+// cannot reach its target (e.g. low-poly meshes with sharp borders, or
+// flat-shaded ones, whose creases the simplifier never moves).
+void Scene::buildLods(Mesh& mesh) {
+    const float ratios[MAX_LODS] = {1.0f, 0.5f, 0.25f, 0.125f};
+    const size_t minIndices = 3 * 64; // Not worth it below ~64 triangles
+
+    mesh.lods[0] = {0, static_cast<int>(mesh.indices.size())};
+    mesh.lodCount = 1;
+    if (mesh.indices.size() < minIndices * 2) return;
+
+    int stride = mesh.hasTexCoords ? 8 : 6;
+    size_t vertexCount = mesh.vertices.size() / stride;
+    std::vector<unsigned int> simplified;
+    for (int l = 1; l < MAX_LODS; l++) {
+        const MeshLod& previous = mesh.lods[l - 1];
+        size_t target = static_cast<size_t>(mesh.lods[0].indexCount * ratios[l]) / 3 * 3;
+        if (target < minIndices) break;
+
+        simplified.clear();
+        simplifyMesh(mesh.vertices.data(), vertexCount, stride, mesh.indices.data() + previous.indexOffset,
+                     previous.indexCount, target, simplified);
+        if (simplified.size() > previous.indexCount * 0.9) break;
+
+        mesh.lods[l] = {static_cast<int>(mesh.indices.size()), static_cast<int>(simplified.size())};
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+        mesh.lodCount++;
     }
+}
 
-    glGenVertexArrays(1, &floorVAO);
-    glGenBuffers(1, &floorVBO);
-    glGenBuffers(1, &floorEBO);
-    glBindVertexArray(floorVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, floorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(floorVertices), floorVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, floorEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(floorIndices), floorIndices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
+void Scene::setupMeshBuffers(Mesh& mesh) {
+    glGenVertexArrays(1, &mesh.VAO);
+    glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+
+    ArenaScope scope(scratchArena());
+    size_t floatCount;
+    float* positions = MeshRegistry::packPositions(mesh, scratchArena(), floatCount);
+    glGenBuffers(1, &mesh.positionVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.positionVBO);
+    glBufferData(GL_ARRAY_BUFFER, floatCount * sizeof(float), positions, GL_STATIC_DRAW);
+
+    setupMeshVertexArray(mesh);
 }
 
-void Scene::setupObjectBuffers(Object& obj) {
-    glGenVertexArrays(1, &obj.VAO);
-    glGenBuffers(1, &obj.VBO);
-    glGenBuffers(1, &obj.EBO);
-    glBindVertexArray(obj.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, obj.VBO);
-    glBufferData(GL_ARRAY_BUFFER, obj.vertices.size() * sizeof(float), obj.vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, obj.indices.size() * sizeof(unsigned int), obj.indices.data(), GL_STATIC_DRAW);
+// VAO over existing VBO/EBO. VAOs are not shared between contexts, so this
+// always runs on the render thread, even when the buffers came from UploadThread.
+void Scene::setupMeshVertexArray(Mesh& mesh) {
+    if (mesh.VAO == 0) glGenVertexArrays(1, &mesh.VAO);
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
 
-    int stride = obj.hasTexCoords ? 8 * sizeof(float) : 6 * sizeof(float);
+    int stride = mesh.hasTexCoords ? 8 * sizeof(float) : 6 * sizeof(float);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
-    if (obj.hasTexCoords) {
+    if (mesh.hasTexCoords) {
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
     }
+
+    // Depth-only passes fetch 12 bytes per vertex instead of the whole vertex
+    if (mesh.depthVAO == 0) glGenVertexArrays(1, &mesh.depthVAO);
+    glBindVertexArray(mesh.depthVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.positionVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
     glBindVertexArray(0);
 }
 
-void Scene::initScene() {
-    initFloor();
+void Scene::initScene(JobSystem* jobSystem) {
+    jobs = jobSystem;
     // No default cube; use add() to load objects
+
+    // Sun matching the old hard-coded lighting
+    Entity sun = world.create();
+    world.add<LightComponent>(sun, LightComponent());
 }
 
 void Scene::cleanupScene() {
-    for (auto& obj : objects) {
-        glDeleteVertexArrays(1, &obj.VAO);
-        glDeleteBuffers(1, &obj.VBO);
-        glDeleteBuffers(1, &obj.EBO);
+    // Let in-flight parses finish, then drop anything never uploaded
+    if (jobs) jobs->wait(&loadCounter);
+    delete deferredUpload;
+    deferredUpload = nullptr;
+    while (AsyncLoad* load = uploadQueue.pop()) {
+        delete load;
+    }
+    if (uploader) {
+        // Buffers live in the share group, so they can be freed from this context
+        uploader->stop();
+        while (AsyncLoad* load = uploader->popCompleted()) {
+            fencedUploads.push_back(load);
+        }
+        for (AsyncLoad* load : fencedUploads) {
+            glDeleteSync(load->fence);
+            MeshRegistry::deleteBuffers(load->mesh);
+            delete load;
+        }
+        fencedUploads.clear();
     }
-    glDeleteVertexArrays(1, &floorVAO);
-    glDeleteBuffers(1, &floorVBO);
-    glDeleteBuffers(1, &floorEBO);
+
+    pendingRemovals.clear();
+    world.clear();
+    meshes.clear();
 }
 
-bool Scene::add(const std::string& filename, float position[3]) {
-    Object obj;
-    obj.position[0] = position[0];
-    obj.position[1] = position[1];
-    obj.position[2] = position[2];
+bool Scene::add(const std::string& filename, float position[3], CpuResidency residency) {
+    AllocTagScope tag(AllocTag::Loader);
+    std::string path = MeshRegistry::canonicalPath(filename);
+    MeshHandle mesh = meshes.findPath(path);
+    if (!meshes.valid(mesh)) {
+        std::string contents;
+        if (!readFile(filename, contents)) {
+            return false;
+        }
+        uint64_t hash = MeshRegistry::hashContents(contents);
+        mesh = meshes.findHash(hash);
+        if (meshes.valid(mesh)) {
+            meshes.addPath(mesh, path);
+        } else {
+            Mesh data;
+            parseObj(contents, data.vertices, data.indices, data.hasTexCoords);
+            computeBounds(data);
+            buildLods(data);
+            setupMeshBuffers(data);
+            applyResidency(data, residency);
+            mesh = meshes.insert(std::move(data), path, hash);
+        }
+    }
+    spawnObject(mesh, position);
+    return true;
+}
 
-    if (!loadObj(filename, obj.vertices, obj.indices, obj.hasTexCoords)) {
-        return false;
+LoadHandle Scene::addAsync(const std::string& filename, const float position[3], CpuResidency residency) {
+    AllocTagScope tag(AllocTag::Loader);
+    LoadHandle handle = static_cast<LoadHandle>(loadStates.size());
+    loadStates.push_back(LoadState::Pending);
+    loadedEntities.push_back(Entity());
+
+    // Already loaded: nothing to parse or upload
+    std::string path = MeshRegistry::canonicalPath(filename);
+    MeshHandle mesh = meshes.findPath(path);
+    if (meshes.valid(mesh)) {
+        loadedEntities[handle] = spawnObject(mesh, position);
+        loadStates[handle] = LoadState::Loaded;
+        return handle;
     }
 
-    setupObjectBuffers(obj);
-    objects.push_back(obj);
-    return true;
-}
\ No newline at end of file
+    AsyncLoad* load = new AsyncLoad();
+    load->filename = filename;
+    load->path = path;
+    load->handle = handle;
+    load->position[0] = position[0];
+    load->position[1] = position[1];
+    load->position[2] = position[2];
+    load->residency = residency;
+
+    auto parse = [](Scene* scene, AsyncLoad* load) {
+        AllocTagScope tag(AllocTag::Loader);
+        std::string contents;
+        load->ok = readFile(load->filename, contents);
+        if (load->ok) {
+            load->hash = MeshRegistry::hashContents(contents);
+            parseObj(contents, load->mesh.vertices, load->mesh.indices, load->mesh.hasTexCoords);
+            computeBounds(load->mesh);
+            buildLods(load->mesh);
+        }
+        if (load->ok && scene->uploader && scene->uploader->running()) {
+            scene->uploader->submit(load);
+        } else {
+            scene->uploadQueue.push(load);
+        }
+    };
+
+    if (jobs) {
+        Scene* scene = this;
+        jobs->run(&loadCounter, [parse, scene, load]() { parse(scene, load); });
+    } else {
+        parse(this, load);
+    }
+    return handle;
+}
+
+int Scene::processUploads(size_t budgetBytes, double budgetMs) {
+    AllocTagScope tag(AllocTag::Scene);
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    size_t uploadedBytes = 0;
+    int uploaded = 0;
+
+    // Buffers filled by the upload thread only need a VAO once their fence has
+    // signalled. Fences complete in submission order, so stop at the first pending one.
+    if (uploader) {
+        while (AsyncLoad* load = uploader->popCompleted()) {
+            fencedUploads.push_back(load);
+        }
+        size_t ready = 0;
+        for (; ready < fencedUploads.size(); ready++) {
+            AsyncLoad* load = fencedUploads[ready];
+            double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (uploaded > 0 && elapsedMs >= budgetMs) break;
+            GLenum status = glClientWaitSync(load->fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+            glDeleteSync(load->fence);
+            load->fence = nullptr;
+            load->mesh.VAO = load->mesh.depthVAO = 0;
+            setupMeshVertexArray(load->mesh);
+            finishLoad(load);
+            uploaded++;
+        }
+        fencedUploads.erase(fencedUploads.begin(), fencedUploads.begin() + ready);
+    }
+
+    while (true) {
+        AsyncLoad* load = deferredUpload ? deferredUpload : uploadQueue.pop();
+        deferredUpload = nullptr;
+        if (!load) break;
+
+        if (!load->ok) {
+            loadStates[load->handle] = LoadState::Failed;
+            delete load;
+            continue;
+        }
+
+        // Identical contents may have finished loading since; skip the upload
+        bool duplicate = meshes.valid(meshes.findHash(load->hash));
+        size_t bytes = duplicate ? 0 : MeshRegistry::uploadBytes(load->mesh);
+        double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (uploaded > 0 && (uploadedBytes + bytes > budgetBytes || elapsedMs >= budgetMs)) {
+            deferredUpload = load; // Next frame
+            break;
+        }
+
+        if (!duplicate) setupMeshBuffers(load->mesh);
+        finishLoad(load);
+        uploadedBytes += bytes;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+void Scene::finishLoad(AsyncLoad* load) {
+    MeshHandle mesh = meshes.findHash(load->hash);
+    if (meshes.valid(mesh)) {
+        // Same contents loaded under another request; drop this copy
+        MeshRegistry::deleteBuffers(load->mesh);
+        meshes.addPath(mesh, load->path);
+    } else {
+        applyResidency(load->mesh, load->residency);
+        mesh = meshes.insert(std::move(load->mesh), load->path, load->hash);
+    }
+    loadedEntities[load->handle] = spawnObject(mesh, load->position);
+    loadStates[load->handle] = LoadState::Loaded;
+    delete load;
+}
+
+void Scene::remove(Entity entity) {
+    pendingRemovals.push_back(entity);
+}
+
+void Scene::applyRemovals() {
+    if (pendingRemovals.empty()) return;
+    AllocGuardPause pause;
+    for (Entity entity : pendingRemovals) {
+        if (!world.alive(entity)) continue; // Removed twice
+        if (Object* obj = world.get<Object>(entity)) meshes.release(obj->mesh);
+        if (TransformComponent* transform = world.get<TransformComponent>(entity)) transforms.destroy(transform->handle);
+        world.destroy(entity);
+    }
+    pendingRemovals.clear();
+}
+
+bool Scene::setParent(Entity child, Entity parent) {
+    TransformComponent* childTransform = world.get<TransformComponent>(child);
+    if (!childTransform) return false;
+    TransformComponent* parentTransform = world.get<TransformComponent>(parent);
+    return transforms.setParent(childTransform->handle, parentTransform ? parentTransform->handle : TransformHandle());
+}
+
+// glBufferData has copied the data by the time a mesh is registered, so the
+// CPU copies can go
+void Scene::applyResidency(Mesh& mesh, CpuResidency residency) {
+    int stride = mesh.hasTexCoords ? 8 : 6;
+    mesh.vertexCount = static_cast<int>(mesh.vertices.size() / stride);
+    mesh.indexCount = mesh.lods[0].indexCount;
+    mesh.gpuBytes = MeshRegistry::uploadBytes(mesh);
+    if (residency == CpuResidency::Full) return;
+
+    if (residency == CpuResidency::PositionsOnly) {
+        mesh.indices.resize(mesh.indexCount);
+        mesh.indices.shrink_to_fit();
+        mesh.positions.resize(MeshRegistry::positionBytes(mesh) / sizeof(float));
+        MeshRegistry::packPositions(mesh, mesh.positions.data());
+    } else {
+        std::vector<unsigned int>().swap(mesh.indices);
+    }
+    std::vector<float>().swap(mesh.vertices);
+}
+
+Entity Scene::spawnObject(MeshHandle handle, const float position[3]) {
+    meshes.acquire(handle);
+    const Mesh& mesh = meshes.get(handle);
+    TransformHandle transform = transforms.create({position[0], position[1], position[2]});
+    transforms.setLocalBounds(transform, mesh.boundsCenter, mesh.boundsRadius);
+
+    Object obj;
+    obj.mesh = handle;
+    obj.VAO = mesh.VAO;
+    obj.depthVAO = mesh.depthVAO;
+    obj.lodCount = static_cast<uint8_t>(mesh.lodCount);
+    for (int i = 0; i < mesh.lodCount; i++) obj.lods[i] = mesh.lods[i];
+
+    Entity entity = world.create();
+    world.add<TransformComponent>(entity, {transform});
+    world.add<Object>(entity, obj);
+    return entity;
+}
+
+Entity Scene::addLight(const LightComponent& light, const float position[3]) {
+    Entity entity = world.create();
+    world.add<TransformComponent>(entity, {transforms.create({position[0], position[1], position[2]})});
+    world.add<LightComponent>(entity, light);
+    return entity;
+}
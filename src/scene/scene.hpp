@@ -2,35 +2,120 @@
 #define SCENE_HPP
 
 #include <glad/glad.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include "../jobs/jobs.hpp"
+#include "../jobs/mpsc_queue.hpp"
+#include "../ecs/ecs.hpp"
+#include "components.hpp"
+#include "mesh_registry.hpp"
+#include "transforms.hpp"
 
+struct UploadThread;
+struct Terrain;
+
+// What stays in CPU memory once a mesh is on the GPU
+enum class CpuResidency {
+    Release,       // Nothing; only counts, bounds and GL names (default)
+    PositionsOnly, // Compact positions + indices for picking/physics
+    Full           // Keep the interleaved vertex data as loaded
+};
+
+// Renderable component; its entity also has a TransformComponent. The mesh
+// itself is shared through Scene::meshes; VAO and LOD ranges are cached for
+// draws. lod is the current level, updated by FramePipeline.
 struct Object {
-    std::vector<float> vertices;       // pos (3) + normal (3) per vertex
-    std::vector<unsigned int> indices; // Indices for drawing
-    unsigned int VAO, VBO, EBO;
-    float position[3];                 // Object's position in world space
-    bool hasTexCoords;                 // Whether the OBJ has texture coords
+    MeshHandle mesh;
+    unsigned int VAO = 0;
+    unsigned int depthVAO = 0; // Positions only
+    MeshLod lods[MAX_LODS];
+    uint8_t lodCount = 1;
+    uint8_t lod = 0;
+};
+
+// Returned by Scene::addAsync; index into Scene::loadStates.
+using LoadHandle = uint32_t;
+
+enum class LoadState {
+    Pending,  // Parsing on a worker or waiting for its GPU upload
+    Loaded,   // Uploaded and spawned as an entity in Scene::world
+    Failed
+};
+
+// One in-flight addAsync request. Allocated on the calling thread, filled by a
+// worker job, then handed to the render thread through the upload queue.
+struct AsyncLoad {
+    std::atomic<AsyncLoad*> next{nullptr};
+    std::string filename;
+    std::string path;       // Canonical, for the registry
+    uint64_t hash = 0;      // Of the file contents
+    LoadHandle handle = 0;
+    float position[3];
+    CpuResidency residency = CpuResidency::Release;
+    Mesh mesh;
+    bool ok = false;
+    GLsync fence = nullptr; // Set by UploadThread once VBO/EBO are filled
 };
 
 struct Scene {
-    // Collection of objects (replaces single cube)
-    std::vector<Object> objects;
+    // Entities: meshes (Object + TransformComponent), lights, cameras
+    World world;
+    TransformStore transforms;
+    MeshRegistry meshes;
+
+    Terrain* terrain = nullptr; // Optional; selected by the pipeline, drawn after objects
 
-    // Floor data (unchanged)
-    float floorVertices[121 * 6]; // 11x11 points, 3 pos + 3 normal
-    unsigned int floorIndices[1200];
-    unsigned int floorVAO, floorVBO, floorEBO;
+    // Async loading: OBJs parse on jobs and queue up for the render thread
+    JobSystem* jobs = nullptr;
+    UploadThread* uploader = nullptr; // Optional; buffers then upload off-thread
+    std::vector<LoadState> loadStates;
+    std::vector<Entity> loadedEntities;
 
-    void initScene();           // Initialize floor only
-    void cleanupScene();        // Cleanup all objects and floor
-    bool add(const std::string& filename, float position[3]); // Add an OBJ at a position
+    void initScene(JobSystem* jobSystem = nullptr); // Default sun light
+    void cleanupScene();        // Cleanup all objects
+    // Add an OBJ at a position. A file already in the registry (by path or
+    // contents) is shared instead of reloaded; the first load's residency
+    // decides which CPU copies are kept after upload.
+    bool add(const std::string& filename, float position[3], CpuResidency residency = CpuResidency::Release);
+    LoadHandle addAsync(const std::string& filename, const float position[3], // Returns immediately
+                        CpuResidency residency = CpuResidency::Release);
+    LoadState loadState(LoadHandle handle) const { return loadStates[handle]; }
+    Entity loadedEntity(LoadHandle handle) const { return loadedEntities[handle]; }
+    // Queues the entity; applyRemovals() destroys it and drops its mesh
+    // reference and transform
+    void remove(Entity entity);
+    void applyRemovals(); // Only while the update thread is idle; FramePipeline::sync() calls it
+    // Point or spot light placed by its own transform (move it with setParent
+    // or the transform store); directional lights need no position
+    Entity addLight(const LightComponent& light, const float position[3]);
+
+    // Parents child's transform to parent's; an entity without a transform detaches
+    bool setParent(Entity child, Entity parent);
+
+    // Render thread: upload finished meshes until either budget is spent. At
+    // least one mesh is uploaded per call so oversized assets still progress.
+    int processUploads(size_t budgetBytes, double budgetMs);
 
 private:
-    bool loadObj(const std::string& filename, std::vector<float>& vertices, 
-                 std::vector<unsigned int>& indices, bool& hasTexCoords);
-    void initFloor();
-    void setupObjectBuffers(Object& obj);
+    MpscQueue<AsyncLoad> uploadQueue;
+    AsyncLoad* deferredUpload = nullptr; // Popped but over this frame's budget
+    std::vector<AsyncLoad*> fencedUploads; // From uploader, waiting on their fence
+    JobCounter loadCounter;
+    std::vector<Entity> pendingRemovals;
+
+    static bool readFile(const std::string& filename, std::string& contents);
+    static void parseObj(const std::string& contents, std::vector<float>& vertices,
+                         std::vector<unsigned int>& indices, bool& hasTexCoords);
+    static void computeBounds(Mesh& mesh);
+    static void buildLods(Mesh& mesh);
+    void setupMeshBuffers(Mesh& mesh);
+    void setupMeshVertexArray(Mesh& mesh);
+    void finishLoad(AsyncLoad* load);
+    Entity spawnObject(MeshHandle mesh, const float position[3]);
+    static void applyResidency(Mesh& mesh, CpuResidency residency);
 };
 
 #endif
\ No newline at end of file
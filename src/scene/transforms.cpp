@@ -0,0 +1,302 @@
+#include "transforms.hpp"
+#include <cmath>
+#include <iostream>
+
+TransformHandle TransformStore::create(vec3 position, quat rotation, vec3 scale) {
+    TransformHandle handle;
+    if (!freeIndices.empty()) {
+        handle.index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        handle.index = static_cast<uint32_t>(sparseToDense.size());
+        sparseToDense.push_back(0);
+        generations.push_back(0);
+        childCount.push_back(0);
+    }
+    handle.generation = generations[handle.index];
+    childCount[handle.index] = 0;
+
+    uint32_t dense = static_cast<uint32_t>(posX.size());
+    sparseToDense[handle.index] = dense;
+    denseToSparse.push_back(handle.index);
+
+    posX.push_back(position.x); posY.push_back(position.y); posZ.push_back(position.z);
+    rotX.push_back(rotation.x); rotY.push_back(rotation.y); rotZ.push_back(rotation.z); rotW.push_back(rotation.w);
+    scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+    localCenterX.push_back(0.0f); localCenterY.push_back(0.0f); localCenterZ.push_back(0.0f); localRadius.push_back(0.0f);
+    world.push_back(mat4FromTRS(position, rotation, scale));
+    worldNormal.push_back(normalMatrix(world.back()));
+    worldCenterX.push_back(position.x); worldCenterY.push_back(position.y); worldCenterZ.push_back(position.z);
+    worldRadius.push_back(0.0f);
+    parentIndex.push_back(NO_PARENT);
+    parentSlot.push_back(NO_PARENT);
+    dirty.push_back(1);
+    uniformScale.push_back(0);
+    updatedPass.push_back(0);
+
+    // A new root can join the last level without breaking breadth-first order
+    if (!orderDirty) {
+        if (levelStart.size() < 2) levelStart.assign({0, 0});
+        levelStart.back() = dense + 1;
+    }
+    return handle;
+}
+
+void TransformStore::destroy(TransformHandle handle) {
+    if (!valid(handle)) return;
+
+    uint32_t dense = sparseToDense[handle.index];
+    if (childCount[handle.index] > 0) {
+        for (size_t i = 0; i < size(); i++) {
+            if (parentIndex[i] == handle.index) {
+                parentIndex[i] = NO_PARENT;
+                dirty[i] = 1;
+            }
+        }
+        childCount[handle.index] = 0;
+    }
+    if (parentIndex[dense] != NO_PARENT) childCount[parentIndex[dense]]--;
+
+    // Swap the last dense slot into the hole so arrays stay packed; the
+    // breadth-first order is restored on the next update
+    orderDirty = true;
+    uint32_t last = static_cast<uint32_t>(posX.size()) - 1;
+    auto moveLast = [dense, last](auto& array) {
+        array[dense] = array[last];
+        array.pop_back();
+    };
+    moveLast(posX); moveLast(posY); moveLast(posZ);
+    moveLast(rotX); moveLast(rotY); moveLast(rotZ); moveLast(rotW);
+    moveLast(scaleX); moveLast(scaleY); moveLast(scaleZ);
+    moveLast(localCenterX); moveLast(localCenterY); moveLast(localCenterZ); moveLast(localRadius);
+    moveLast(world); moveLast(worldNormal);
+    moveLast(worldCenterX); moveLast(worldCenterY); moveLast(worldCenterZ); moveLast(worldRadius);
+    moveLast(parentIndex); moveLast(parentSlot); moveLast(dirty); moveLast(uniformScale); moveLast(updatedPass);
+
+    uint32_t movedSparse = denseToSparse[last];
+    denseToSparse[dense] = movedSparse;
+    denseToSparse.pop_back();
+    sparseToDense[movedSparse] = dense;
+
+    generations[handle.index]++;
+    freeIndices.push_back(handle.index);
+}
+
+bool TransformStore::valid(TransformHandle handle) const {
+    return handle.index < generations.size() && generations[handle.index] == handle.generation;
+}
+
+void TransformStore::setPosition(TransformHandle handle, vec3 position) {
+    uint32_t i = slot(handle);
+    posX[i] = position.x; posY[i] = position.y; posZ[i] = position.z;
+    dirty[i] = 1;
+}
+
+void TransformStore::setRotation(TransformHandle handle, quat rotation) {
+    uint32_t i = slot(handle);
+    rotX[i] = rotation.x; rotY[i] = rotation.y; rotZ[i] = rotation.z; rotW[i] = rotation.w;
+    dirty[i] = 1;
+}
+
+void TransformStore::setScale(TransformHandle handle, vec3 scale) {
+    uint32_t i = slot(handle);
+    scaleX[i] = scale.x; scaleY[i] = scale.y; scaleZ[i] = scale.z;
+    dirty[i] = 1;
+}
+
+void TransformStore::setLocalBounds(TransformHandle handle, vec3 center, float radius) {
+    uint32_t i = slot(handle);
+    localCenterX[i] = center.x; localCenterY[i] = center.y; localCenterZ[i] = center.z;
+    localRadius[i] = radius;
+    dirty[i] = 1;
+}
+
+vec3 TransformStore::position(TransformHandle handle) const {
+    uint32_t i = slot(handle);
+    return {posX[i], posY[i], posZ[i]};
+}
+
+bool TransformStore::setParent(TransformHandle child, TransformHandle parent) {
+    if (!valid(child)) return false;
+    uint32_t newParent = valid(parent) ? parent.index : NO_PARENT;
+    for (uint32_t p = newParent; p != NO_PARENT; p = parentIndex[sparseToDense[p]]) {
+        if (p == child.index) {
+            std::cerr << "TransformStore: setParent would create a cycle" << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t i = slot(child);
+    if (parentIndex[i] == newParent) return true;
+    if (parentIndex[i] != NO_PARENT) childCount[parentIndex[i]]--;
+    if (newParent != NO_PARENT) childCount[newParent]++;
+    parentIndex[i] = newParent;
+    dirty[i] = 1;
+    orderDirty = true;
+    return true;
+}
+
+TransformHandle TransformStore::parent(TransformHandle handle) const {
+    TransformHandle result;
+    if (!valid(handle)) return result;
+    uint32_t p = parentIndex[slot(handle)];
+    if (p != NO_PARENT) {
+        result.index = p;
+        result.generation = generations[p];
+    }
+    return result;
+}
+
+void TransformStore::rebuildOrder() {
+    size_t n = size();
+    for (size_t i = 0; i < n; i++) {
+        parentSlot[i] = parentIndex[i] == NO_PARENT ? NO_PARENT : sparseToDense[parentIndex[i]];
+    }
+
+    // Children of each slot as one flat list (counting sort by parent)
+    std::vector<uint32_t> firstChild(n + 1, 0), children(n);
+    for (size_t i = 0; i < n; i++) {
+        if (parentSlot[i] != NO_PARENT) firstChild[parentSlot[i] + 1]++;
+    }
+    for (size_t i = 0; i < n; i++) firstChild[i + 1] += firstChild[i];
+    std::vector<uint32_t> cursor(firstChild.begin(), firstChild.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        if (parentSlot[i] != NO_PARENT) children[cursor[parentSlot[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    // Breadth-first: roots in their current order, then one level at a time
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (parentSlot[i] == NO_PARENT) order.push_back(static_cast<uint32_t>(i));
+    }
+    levelStart.assign(1, 0);
+    while (order.size() > levelStart.back()) {
+        uint32_t begin = levelStart.back();
+        uint32_t end = static_cast<uint32_t>(order.size());
+        levelStart.push_back(end);
+        for (uint32_t k = begin; k < end; k++) {
+            for (uint32_t c = firstChild[order[k]]; c < firstChild[order[k] + 1]; c++) order.push_back(children[c]);
+        }
+    }
+
+    auto permute = [&order](auto& array) {
+        auto sorted = array;
+        for (size_t k = 0; k < order.size(); k++) sorted[k] = array[order[k]];
+        array.swap(sorted);
+    };
+    permute(posX); permute(posY); permute(posZ);
+    permute(rotX); permute(rotY); permute(rotZ); permute(rotW);
+    permute(scaleX); permute(scaleY); permute(scaleZ);
+    permute(localCenterX); permute(localCenterY); permute(localCenterZ); permute(localRadius);
+    permute(world); permute(worldNormal);
+    permute(worldCenterX); permute(worldCenterY); permute(worldCenterZ); permute(worldRadius);
+    permute(parentIndex); permute(dirty); permute(uniformScale); permute(updatedPass);
+    permute(denseToSparse);
+
+    for (size_t k = 0; k < n; k++) sparseToDense[denseToSparse[k]] = static_cast<uint32_t>(k);
+    for (size_t k = 0; k < n; k++) {
+        parentSlot[k] = parentIndex[k] == NO_PARENT ? NO_PARENT : sparseToDense[parentIndex[k]];
+    }
+    orderDirty = false;
+}
+
+void TransformStore::updateWorldMatrices(JobSystem* jobs) {
+    if (orderDirty) rebuildOrder();
+    pass++;
+
+    // Levels run in order so parents are final before their children read them
+    for (size_t level = 0; level + 1 < levelStart.size(); level++) {
+        uint32_t begin = levelStart[level];
+        uint32_t count = levelStart[level + 1] - begin;
+        if (jobs) {
+            // Batch size is a multiple of 4 so only the final batch has a scalar tail
+            jobs->parallelFor(count, 4096, [this, begin](unsigned int b, unsigned int e) { updateRange(begin + b, begin + e); });
+        } else {
+            updateRange(begin, begin + count);
+        }
+    }
+}
+
+void TransformStore::finishSlot(size_t i, const mat4& local) {
+    uint32_t p = parentSlot[i];
+    world[i] = p == NO_PARENT ? local : mul(world[p], local);
+
+    // Rotation and uniform scale all the way up: the 3x3 itself is a normal
+    // matrix; otherwise the full inverse transpose
+    bool uniform = scaleX[i] == scaleY[i] && scaleY[i] == scaleZ[i] && (p == NO_PARENT || uniformScale[p]);
+    uniformScale[i] = uniform;
+    worldNormal[i] = uniform ? mat3FromMat4(world[i]) : normalMatrix(world[i]);
+
+    // Bounding sphere: transform the center, scale the radius by the longest axis
+    const float* m = world[i].m;
+    float cx = localCenterX[i], cy = localCenterY[i], cz = localCenterZ[i];
+    worldCenterX[i] = m[0] * cx + m[4] * cy + m[8] * cz + m[12];
+    worldCenterY[i] = m[1] * cx + m[5] * cy + m[9] * cz + m[13];
+    worldCenterZ[i] = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+    float axisX = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+    float axisY = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+    float axisZ = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+    worldRadius[i] = localRadius[i] * std::sqrt(std::fmax(axisX, std::fmax(axisY, axisZ)));
+
+    dirty[i] = 0;
+    updatedPass[i] = pass;
+}
+
+void TransformStore::updateRange(size_t begin, size_t end) {
+    // Dirty itself, or its parent was rebuilt earlier in this pass
+    auto changed = [this](size_t i) {
+        return dirty[i] || (parentSlot[i] != NO_PARENT && updatedPass[parentSlot[i]] == pass);
+    };
+
+    size_t i = begin;
+#if CISCO_MATH_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= end; i += 4) {
+        int lanes = 0;
+        for (int k = 0; k < 4; k++) {
+            if (changed(i + k)) lanes |= 1 << k;
+        }
+        if (!lanes) continue;
+
+        __m128 qx = _mm_loadu_ps(&rotX[i]), qy = _mm_loadu_ps(&rotY[i]), qz = _mm_loadu_ps(&rotZ[i]), qw = _mm_loadu_ps(&rotW[i]);
+        __m128 sx = _mm_loadu_ps(&scaleX[i]), sy = _mm_loadu_ps(&scaleY[i]), sz = _mm_loadu_ps(&scaleZ[i]);
+        __m128 tx = _mm_loadu_ps(&posX[i]), ty = _mm_loadu_ps(&posY[i]), tz = _mm_loadu_ps(&posZ[i]);
+
+        __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+        // Rotation * scale, one register per matrix element across 4 objects
+        __m128 m0 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        __m128 m1 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+        __m128 m2 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+        __m128 m4 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+        __m128 m5 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        __m128 m6 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+        __m128 m8 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+        __m128 m9 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+        __m128 m10 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+        // Transpose element-major registers into one local matrix per object
+        mat4 local[4];
+        __m128 cols[4][4] = {{m0, m1, m2, zero}, {m4, m5, m6, zero}, {m8, m9, m10, zero}, {tx, ty, tz, one}};
+        for (int c = 0; c < 4; c++) {
+            _MM_TRANSPOSE4_PS(cols[c][0], cols[c][1], cols[c][2], cols[c][3]);
+            for (int k = 0; k < 4; k++) {
+                _mm_store_ps(local[k].m + c * 4, cols[c][k]);
+            }
+        }
+        for (int k = 0; k < 4; k++) {
+            if (lanes & (1 << k)) finishSlot(i + k, local[k]);
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        if (!changed(i)) continue;
+        finishSlot(i, mat4FromTRS({posX[i], posY[i], posZ[i]}, {rotX[i], rotY[i], rotZ[i], rotW[i]}, {scaleX[i], scaleY[i], scaleZ[i]}));
+    }
+}
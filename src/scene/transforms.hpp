@@ -0,0 +1,85 @@
+#ifndef TRANSFORMS_HPP
+#define TRANSFORMS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../jobs/jobs.hpp"
+#include "../math/math.hpp"
+
+// Stable reference to a transform. The dense slot behind it moves when other
+// transforms are destroyed; the generation catches use after destroy.
+struct TransformHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Structure-of-arrays transform hierarchy. Each attribute lives in its own
+// tightly packed array indexed by dense slot, so batch updates stream only the
+// data they touch and can be vectorized four (SSE) objects at a time.
+//
+// Dense slots are kept in breadth-first order (every parent before its
+// children, one contiguous range per depth level), so world matrices are
+// rebuilt in a single linear pass. Setters mark a transform dirty; the pass
+// recomputes only dirty transforms and their descendants. Reparenting and
+// destroy() defer the reordering to the next updateWorldMatrices().
+struct TransformStore {
+    // Inputs, dense slot order; position/rotation/scale are relative to the parent
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> rotX, rotY, rotZ, rotW;
+    std::vector<float> scaleX, scaleY, scaleZ;
+    std::vector<float> localCenterX, localCenterY, localCenterZ, localRadius; // Bounding sphere
+
+    // Outputs of updateWorldMatrices()
+    std::vector<mat4> world;
+    std::vector<mat3> worldNormal; // Inverse transpose of world's 3x3, for normals
+    std::vector<float> worldCenterX, worldCenterY, worldCenterZ, worldRadius;
+
+    TransformHandle create(vec3 position, quat rotation = quatIdentity(), vec3 scale = {1.0f, 1.0f, 1.0f});
+    void destroy(TransformHandle handle); // Children become roots
+    bool valid(TransformHandle handle) const;
+    size_t size() const { return posX.size(); }
+
+    uint32_t slot(TransformHandle handle) const { return sparseToDense[handle.index]; }
+    void setPosition(TransformHandle handle, vec3 position);
+    void setRotation(TransformHandle handle, quat rotation);
+    void setScale(TransformHandle handle, vec3 scale);
+    void setLocalBounds(TransformHandle handle, vec3 center, float radius);
+    vec3 position(TransformHandle handle) const;
+    const mat4& worldMatrix(TransformHandle handle) const { return world[slot(handle)]; }
+    const mat3& worldNormalMatrix(TransformHandle handle) const { return worldNormal[slot(handle)]; }
+
+    // An invalid parent handle detaches. Fails on cycles.
+    bool setParent(TransformHandle child, TransformHandle parent);
+    TransformHandle parent(TransformHandle handle) const;
+
+    // Rebuilds world matrices and world bounds of dirty transforms and their
+    // descendants, level by level. Splits each level across jobs when a
+    // JobSystem is given.
+    void updateWorldMatrices(JobSystem* jobs = nullptr);
+    // Kernel over dense slots [begin, end) of one level; exposed for benchmarks
+    void updateRange(size_t begin, size_t end);
+
+private:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    std::vector<uint32_t> parentIndex;   // Dense order; sparse index of the parent
+    std::vector<uint32_t> parentSlot;    // Dense order; dense slot of the parent, valid after reorder
+    std::vector<uint8_t> dirty;          // Dense order; set by the setters
+    std::vector<uint8_t> uniformScale;   // Dense order; world has uniform scale (no shear)
+    std::vector<uint32_t> updatedPass;   // Dense order; pass that last rebuilt the slot
+    std::vector<uint32_t> levelStart;    // Dense range of each depth level, plus the end
+    std::vector<uint32_t> childCount;    // Sparse order
+    uint32_t pass = 0;
+    bool orderDirty = false;
+
+    std::vector<uint32_t> sparseToDense;
+    std::vector<uint32_t> denseToSparse;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeIndices;
+
+    void rebuildOrder();
+    void finishSlot(size_t i, const mat4& local);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "upload_thread.hpp"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+bool UploadThread::start(GLFWwindow* mainWindow) {
+    // Same context version as the main window, but never shown
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context = glfwCreateWindow(1, 1, "Cisco Engine Loader", nullptr, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context) {
+        std::cerr << "Failed to create shared upload context; uploads stay on the render thread" << std::endl;
+        return false;
+    }
+
+    quit = false;
+    thread = std::thread(&UploadThread::threadLoop, this);
+    active.store(true, std::memory_order_release);
+    return true;
+}
+
+void UploadThread::stop() {
+    if (!thread.joinable()) return;
+    active.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+
+    while (AsyncLoad* load = requests.pop()) {
+        delete load;
+    }
+    glfwDestroyWindow(context);
+    context = nullptr;
+}
+
+void UploadThread::submit(AsyncLoad* load) {
+    requests.push(load);
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wake.notify_one();
+}
+
+AsyncLoad* UploadThread::popCompleted() {
+    return completed.pop();
+}
+
+void UploadThread::threadLoop() {
+    glfwMakeContextCurrent(context);
+
+    while (true) {
+        AsyncLoad* load = requests.pop();
+        if (load) {
+            upload(load);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (quit) break;
+        // Timed wait covers a push that was mid-flight when pop() saw empty
+        wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void UploadThread::upload(AsyncLoad* load) {
+    Mesh& mesh = load->mesh;
+    glGenBuffers(1, &mesh.VBO);
+    glGenBuffers(1, &mesh.EBO);
+
+    // GL_COPY_WRITE_BUFFER: binding ELEMENT_ARRAY_BUFFER needs a VAO in core profile
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+    {
+        ArenaScope scope(scratchArena());
+        size_t floatCount;
+        float* positions = MeshRegistry::packPositions(mesh, scratchArena(), floatCount);
+        glGenBuffers(1, &mesh.positionVBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.positionVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, floatCount * sizeof(float), positions, GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    load->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush(); // Make the fence visible to the render context
+    completed.push(load);
+}
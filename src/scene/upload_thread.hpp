@@ -0,0 +1,45 @@
+#ifndef UPLOAD_THREAD_HPP
+#define UPLOAD_THREAD_HPP
+
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "../jobs/mpsc_queue.hpp"
+#include "scene.hpp"
+
+struct GLFWwindow;
+
+// Loader thread with its own GL context shared with the main window. It
+// creates and fills VBO/EBOs, then fences; the render thread only builds the
+// VAO (container objects are not shared between contexts) once the fence has
+// signalled.
+struct UploadThread {
+    // Main thread: creates a hidden 1x1 window sharing mainWindow's objects.
+    bool start(GLFWwindow* mainWindow);
+    // Main thread: joins the thread and destroys its context. Requests that
+    // were never uploaded are deleted; completed ones stay for popCompleted().
+    void stop();
+    bool running() const { return active.load(std::memory_order_acquire); } // Any thread
+
+    void submit(AsyncLoad* load);  // Any thread
+    AsyncLoad* popCompleted();     // Render thread; load->fence is set
+
+private:
+    GLFWwindow* context = nullptr;
+    std::thread thread;
+    std::atomic<bool> quit{false};
+    std::atomic<bool> active{false}; // Set by start(), cleared by stop(); the std::thread is main-thread only
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    MpscQueue<AsyncLoad> requests;
+    MpscQueue<AsyncLoad> completed;
+
+    void threadLoop();
+    void upload(AsyncLoad* load);
+};
+
+#endif
@@ -0,0 +1,339 @@
+#include "program_cache.hpp"
+#include "../memory/alloc_tracker.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// GL 4.1 enums; glad is generated for 3.3
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+// KHR_parallel_shader_compile (same values as the ARB extension)
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+
+const char entryMagic[4] = {'C', 'P', 'B', '1'};
+
+void hashBytes(uint64_t& hash, const char* bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hash ^= static_cast<unsigned char>(bytes[i]);
+        hash *= 1099511628211ull;
+    }
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+bool hasExtension(const char* name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++) {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(reinterpret_cast<const char*>(extension), name) == 0) return true;
+    }
+    return false;
+}
+
+unsigned int compileStage(GLenum type, const char* source) {
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+void reportStage(unsigned int shader, const char* stage, const std::string& name) {
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << name << " " << stage << " Shader Error: " << infoLog << std::endl;
+    }
+}
+
+} // namespace
+
+ProgramCache& programCache() {
+    static ProgramCache cache;
+    return cache;
+}
+
+bool ProgramCache::init(const std::string& cacheDirectory, GLADloadproc loader) {
+    AllocTagScope tag(AllocTag::Shader);
+    enabled = false;
+
+    // Let the driver use as many compiler threads as it likes
+    parallel = false;
+    const char* parallelExtensions[2][2] = {{"GL_KHR_parallel_shader_compile", "glMaxShaderCompilerThreadsKHR"},
+                                            {"GL_ARB_parallel_shader_compile", "glMaxShaderCompilerThreadsARB"}};
+    for (const auto& extension : parallelExtensions) {
+        if (parallel || !hasExtension(extension[0])) continue;
+        auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loader(extension[1]));
+        if (maxThreads) maxThreads(0xFFFFFFFFu);
+        parallel = true;
+    }
+
+    getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(loader("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryProc>(loader("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriProc>(loader("glProgramParameteri"));
+    int formats = 0;
+    if (getProgramBinary && programBinary && programParameteri) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    if (formats <= 0) {
+        std::cerr << "ProgramCache: program binaries not supported, compiling from source" << std::endl;
+        return false;
+    }
+
+    directory = cacheDirectory;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "ProgramCache: cannot create " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    // Binaries from another driver can never load again; drop them
+    driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    std::string stampPath = directory + "/driver.txt";
+    std::ifstream stampIn(stampPath);
+    std::stringstream stamp;
+    stamp << stampIn.rdbuf();
+    stampIn.close();
+    if (stamp.str() != driver) {
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.path().extension() == ".bin") std::filesystem::remove(entry.path(), error);
+        }
+        std::ofstream stampOut(stampPath, std::ios::trunc);
+        stampOut << driver;
+    }
+
+    enabled = true;
+    return true;
+}
+
+unsigned int ProgramCache::build(const char* vertexSource, const char* fragmentSource, const char* name) {
+    AllocTagScope tag(AllocTag::Shader);
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t entryKey = 0;
+    if (enabled) {
+        entryKey = key(vertexSource, fragmentSource);
+        if (unsigned int program = load(entryKey)) {
+            hits++;
+            return program;
+        }
+        misses++;
+    }
+    PendingProgram compiled = startCompile(vertexSource, fragmentSource, name);
+    compiled.key = entryKey;
+    return finishCompile(compiled);
+}
+
+void ProgramCache::submit(const char* vertexSource, const char* fragmentSource, const char* name,
+                          std::function<void(unsigned int)> onReady) {
+    AllocTagScope tag(AllocTag::Shader);
+    unsigned int cached = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty() && batchPrograms == 0) batchStart = std::chrono::steady_clock::now();
+        batchPrograms++;
+        uint64_t entryKey = 0;
+        if (enabled) {
+            entryKey = key(vertexSource, fragmentSource);
+            cached = load(entryKey);
+            if (cached) {
+                hits++;
+                batchCached++;
+            } else {
+                misses++;
+            }
+        }
+        if (!cached) {
+            pending.push_back(startCompile(vertexSource, fragmentSource, name));
+            pending.back().key = entryKey;
+            pending.back().onReady = std::move(onReady);
+            return;
+        }
+    }
+    onReady(cached);
+}
+
+bool ProgramCache::poll() {
+    AllocTagScope tag(AllocTag::Shader);
+    for (size_t i = 0; i < pending.size();) {
+        int done = GL_TRUE;
+        if (parallel) glGetProgramiv(pending[i].program, GL_COMPLETION_STATUS_KHR, &done);
+        if (done) {
+            finishPending(i);
+        } else {
+            i++;
+        }
+    }
+    if (!pending.empty()) return false;
+    reportBatch();
+    return true;
+}
+
+void ProgramCache::finishAll() {
+    AllocTagScope tag(AllocTag::Shader);
+    while (!pending.empty()) finishPending(pending.size() - 1);
+    reportBatch();
+}
+
+void ProgramCache::finishPending(size_t index) {
+    PendingProgram done = std::move(pending[index]);
+    pending.erase(pending.begin() + index);
+    unsigned int program;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        program = finishCompile(done);
+    }
+    done.onReady(program);
+}
+
+void ProgramCache::reportBatch() {
+    if (batchPrograms == 0) return;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+    std::cout << "Shaders: " << batchPrograms << " programs (" << batchCached << " from cache) in " << ms << " ms"
+              << (parallel ? ", parallel compile" : "") << std::endl;
+    batchPrograms = batchCached = 0;
+}
+
+uint64_t ProgramCache::key(const char* vertexSource, const char* fragmentSource) const {
+    uint64_t hash = 14695981039346656037ull;
+    // Terminators included so moving text between the stages changes the key
+    hashBytes(hash, vertexSource, std::strlen(vertexSource) + 1);
+    hashBytes(hash, fragmentSource, std::strlen(fragmentSource) + 1);
+    hashBytes(hash, driver.data(), driver.size());
+    return hash;
+}
+
+std::string ProgramCache::entryPath(uint64_t entryKey) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(entryKey));
+    return directory + "/" + name;
+}
+
+// Issues the compiles and the link without querying anything, so the driver
+// is free to work on them in the background
+ProgramCache::PendingProgram ProgramCache::startCompile(const char* vertexSource, const char* fragmentSource, const char* name) {
+    PendingProgram compiled;
+    compiled.vertexShader = compileStage(GL_VERTEX_SHADER, vertexSource);
+    compiled.fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentSource);
+    compiled.program = glCreateProgram();
+    glAttachShader(compiled.program, compiled.vertexShader);
+    glAttachShader(compiled.program, compiled.fragmentShader);
+    if (enabled) programParameteri(compiled.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(compiled.program);
+    compiled.key = 0;
+    compiled.name = name;
+    return compiled;
+}
+
+// Caller holds mutex. Shader logs are only read when the link failed.
+unsigned int ProgramCache::finishCompile(PendingProgram& compiled) {
+    unsigned int program = compiled.program;
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        reportStage(compiled.vertexShader, "Vertex", compiled.name);
+        reportStage(compiled.fragmentShader, "Fragment", compiled.name);
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << compiled.name << " Program Error: " << infoLog << std::endl;
+        glDeleteProgram(program);
+        program = 0;
+    }
+    glDeleteShader(compiled.vertexShader);
+    glDeleteShader(compiled.fragmentShader);
+    if (program && enabled) store(compiled.key, program);
+    return program;
+}
+
+// Entry: magic, binary format, key, length, then the driver's blob
+unsigned int ProgramCache::load(uint64_t entryKey) {
+    std::string path = entryPath(entryKey);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    char magic[4];
+    uint32_t format = 0, length = 0;
+    uint64_t storedKey = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    std::vector<char> binary;
+    bool valid = file && std::memcmp(magic, entryMagic, sizeof(magic)) == 0 && storedKey == entryKey && length > 0;
+    if (valid) {
+        binary.resize(length);
+        file.read(binary.data(), length);
+        valid = static_cast<bool>(file);
+    }
+    file.close();
+
+    unsigned int program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        programBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+        int success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    if (!program) {
+        std::error_code error;
+        std::filesystem::remove(path, error); // Stale or corrupt; rebuilt by the caller
+    }
+    return program;
+}
+
+void ProgramCache::store(uint64_t entryKey, unsigned int program) {
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    // Written aside and renamed so a crash never leaves a truncated entry
+    std::string path = entryPath(entryKey);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        uint32_t format32 = format, length32 = static_cast<uint32_t>(written);
+        file.write(entryMagic, sizeof(entryMagic));
+        file.write(reinterpret_cast<const char*>(&format32), sizeof(format32));
+        file.write(reinterpret_cast<const char*>(&entryKey), sizeof(entryKey));
+        file.write(reinterpret_cast<const char*>(&length32), sizeof(length32));
+        file.write(binary.data(), written);
+        if (!file) {
+            std::cerr << "ProgramCache: cannot write " << temporary << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
@@ -0,0 +1,82 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (GL 4.1 / ARB_get_program_binary).
+// Entries are keyed by a hash of the shader sources and the driver's vendor,
+// renderer and version strings, so editing a shader or updating the driver
+// misses and relinks. A driver change also clears the directory, and a binary
+// the driver rejects is deleted and rebuilt from source. Without driver
+// support build() just compiles. build() may be called from any thread with
+// a current context (the shader watcher's, for one); calls are serialized.
+//
+// submit() is the batched path for startup: every compile and link is issued
+// up front and no status is queried until the driver is done, so drivers that
+// compile on their own threads overlap the work. With KHR_parallel_shader_compile
+// poll() checks GL_COMPLETION_STATUS_KHR without blocking; without it poll()
+// finishes everything at once. submit()/poll()/finishAll() are render thread only.
+struct ProgramCache {
+    bool init(const std::string& directory, GLADloadproc loader); // After the GL context is current
+
+    // Linked program from vertex + fragment source, 0 on failure; errors
+    // are reported under name
+    unsigned int build(const char* vertexSource, const char* fragmentSource, const char* name);
+
+    // Queues a build; onReady gets the program (0 on failure) from poll() or
+    // finishAll(), or right away on a cache hit
+    void submit(const char* vertexSource, const char* fragmentSource, const char* name,
+                std::function<void(unsigned int)> onReady);
+    bool poll();      // Finishes completed builds; true once none are pending
+    void finishAll(); // Blocks until every pending build is done
+
+    bool parallelCompile() const { return parallel; }
+    size_t hits = 0, misses = 0;
+
+private:
+    typedef void (APIENTRYP GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+    typedef void (APIENTRYP ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+    typedef void (APIENTRYP ProgramParameteriProc)(GLuint, GLenum, GLint);
+
+    typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint);
+
+    struct PendingProgram {
+        unsigned int program, vertexShader, fragmentShader;
+        uint64_t key;
+        std::string name;
+        std::function<void(unsigned int)> onReady;
+    };
+
+    std::mutex mutex; // Held through build() and submit()
+    std::string directory;
+    std::string driver; // Vendor, renderer and version
+    bool enabled = false;
+    GetProgramBinaryProc getProgramBinary = nullptr;
+    ProgramBinaryProc programBinary = nullptr;
+    ProgramParameteriProc programParameteri = nullptr;
+    bool parallel = false; // KHR/ARB_parallel_shader_compile
+
+    std::vector<PendingProgram> pending;
+    std::chrono::steady_clock::time_point batchStart; // First submit() since the queue was empty
+    size_t batchPrograms = 0, batchCached = 0;
+
+    uint64_t key(const char* vertexSource, const char* fragmentSource) const;
+    std::string entryPath(uint64_t key) const;
+    PendingProgram startCompile(const char* vertexSource, const char* fragmentSource, const char* name);
+    unsigned int finishCompile(PendingProgram& build); // Queries status; deletes the shaders
+    void finishPending(size_t index);
+    void reportBatch();
+    unsigned int load(uint64_t key);
+    void store(uint64_t key, unsigned int program);
+};
+
+ProgramCache& programCache(); // Process-wide; compiles uncached until init()
+
+#endif
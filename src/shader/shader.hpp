@@ -3,6 +3,7 @@
 
 #include <glad/glad.h>
 #include <string>
+#include <unordered_map>
 
 class Shader {
 public:
@@ -11,11 +12,21 @@ public:
     void use() const;
     void setMat4(const std::string& name, const float* value) const;
     void setInt(const std::string& name, int value) const;
+    int uniformLocation(const std::string& name) const; // Cached per program
+
+    const std::string& vertexPath() const { return vertexFile; }
+    const std::string& fragmentPath() const { return fragmentFile; }
+    // Bumped by replaceProgram(); locations cached outside the Shader must be
+    // re-resolved when it changes
+    unsigned int generation() const { return programGeneration; }
+    // Takes ownership of a linked program and deletes the previous one
+    void replaceProgram(unsigned int program);
 
 private:
     unsigned int programID;
-    std::string loadShaderSource(const char* filepath);
-    unsigned int compileShader(GLenum type, const char* source);
+    unsigned int programGeneration = 0;
+    std::string vertexFile, fragmentFile;
+    mutable std::unordered_map<std::string, int> uniformLocations;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,213 @@
+#include "shader_library.hpp"
+#include "program_cache.hpp"
+#include "../memory/alloc_tracker.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* featureNames[SHADER_FEATURE_COUNT] = {"SHADOWS"};
+
+void hashBytes(uint64_t& hash, const void* data, size_t count) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < count; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+} // namespace
+
+ShaderLibrary& shaderLibrary() {
+    static ShaderLibrary library;
+    return library;
+}
+
+unsigned int ShaderLibrary::get(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features) {
+    uint64_t key = variantKey(vertexPath, fragmentPath, features);
+    auto found = variants.find(key);
+    if (found != variants.end()) {
+        if (!found->second.ready) programCache().finishAll(); // Prewarmed, not yet collected
+        return found->second.program;
+    }
+
+    AllocTagScope tag(AllocTag::Shader);
+    Variant& variant = variants[key];
+    variant.ready = true;
+    variant.source = {key, vertexPath, fragmentPath, features, {}};
+    std::string vertexSource, fragmentSource;
+    if (sources(variant, vertexSource, fragmentSource)) {
+        variant.program = programCache().build(vertexSource.c_str(), fragmentSource.c_str(),
+                                               variantName(vertexPath, fragmentPath, features).c_str());
+    }
+    return variant.program;
+}
+
+void ShaderLibrary::prewarm(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features,
+                            std::function<void(unsigned int)> onReady) {
+    AllocTagScope tag(AllocTag::Shader);
+    uint64_t key = variantKey(vertexPath, fragmentPath, features);
+    auto found = variants.find(key);
+    if (found != variants.end()) {
+        if (!onReady) return;
+        if (found->second.ready) onReady(found->second.program);
+        found->second.listeners.push_back(std::move(onReady));
+        return;
+    }
+
+    Variant& variant = variants[key];
+    variant.source = {key, vertexPath, fragmentPath, features, {}};
+    if (onReady) variant.listeners.push_back(std::move(onReady));
+    std::string vertexSource, fragmentSource;
+    if (!sources(variant, vertexSource, fragmentSource)) {
+        variant.ready = true;
+        for (auto& listener : variant.listeners) listener(0);
+        return;
+    }
+    programCache().submit(vertexSource.c_str(), fragmentSource.c_str(), variantName(vertexPath, fragmentPath, features).c_str(),
+                          [this, key](unsigned int program) {
+                              Variant& done = variants[key];
+                              done.program = program;
+                              done.ready = true;
+                              for (auto& listener : done.listeners) listener(program);
+                          });
+}
+
+void ShaderLibrary::clear() {
+    programCache().finishAll(); // No callback may outlive the variants
+    for (auto& entry : variants) {
+        if (entry.second.program) glDeleteProgram(entry.second.program);
+    }
+    variants.clear();
+}
+
+bool ShaderLibrary::replace(uint64_t key, unsigned int program) {
+    auto found = variants.find(key);
+    if (found == variants.end() || !found->second.ready) return false;
+    Variant& variant = found->second;
+    if (variant.program) glDeleteProgram(variant.program);
+    variant.program = program;
+    reloads++;
+    for (auto& listener : variant.listeners) listener(program);
+    return true;
+}
+
+void ShaderLibrary::setSourceListener(std::function<void(const ShaderVariantSource&)> listener) {
+    sourceListener = std::move(listener);
+    if (!sourceListener) return;
+    for (const auto& entry : variants) sourceListener(entry.second.source);
+}
+
+bool ShaderLibrary::preprocess(const std::string& path, uint32_t features, std::string& out, std::vector<std::string>* files) {
+    std::unordered_set<std::string> included;
+    std::string body;
+    bool expanded = expand(path, included, 0, body);
+    if (files) {
+        // Recorded even on failure, so fixing a broken or missing file reloads
+        for (const std::string& file : included) {
+            if (std::find(files->begin(), files->end(), file) == files->end()) files->push_back(file);
+        }
+    }
+    if (!expanded) return false;
+
+    // Defines must follow #version; #line keeps error lines matching the file
+    size_t version = body.find("#version");
+    size_t afterVersion = version == std::string::npos ? 0 : body.find('\n', version);
+    afterVersion = afterVersion == std::string::npos ? body.size() : afterVersion + 1;
+    int nextLine = 1;
+    for (size_t i = 0; i < afterVersion; i++) {
+        if (body[i] == '\n') nextLine++;
+    }
+    std::string defines;
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if (features & (1u << i)) defines += std::string("#define ") + featureNames[i] + " 1\n";
+    }
+    defines += "#line " + std::to_string(nextLine) + " 0\n";
+
+    out.assign(body, 0, afterVersion);
+    out += defines;
+    out.append(body, afterVersion, std::string::npos);
+    return true;
+}
+
+uint64_t ShaderLibrary::variantKey(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features) {
+    uint64_t hash = 14695981039346656037ull;
+    hashBytes(hash, vertexPath.c_str(), vertexPath.size() + 1);
+    hashBytes(hash, fragmentPath.c_str(), fragmentPath.size() + 1);
+    hashBytes(hash, &features, sizeof(features));
+    return hash;
+}
+
+std::string ShaderLibrary::variantName(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features) {
+    std::string name = vertexPath + " + " + fragmentPath;
+    for (int i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if (features & (1u << i)) name += std::string(" ") + featureNames[i];
+    }
+    return name;
+}
+
+// Appends path's contents with its includes expanded in place. Each included
+// file gets its own source-string number in #line, the including file's
+// numbering is restored after it.
+bool ShaderLibrary::expand(const std::string& path, std::unordered_set<std::string>& included, int depth, std::string& out) {
+    if (depth > 16) {
+        std::cerr << "ShaderLibrary: includes nested too deeply at " << path << std::endl;
+        return false;
+    }
+    std::error_code error;
+    std::string canonical = std::filesystem::weakly_canonical(path, error).string();
+    if (error) canonical = path;
+    if (!included.insert(canonical).second) return true; // Already included
+    int fileIndex = static_cast<int>(included.size()) - 1;
+
+    std::ifstream lines(path);
+    if (!lines.is_open()) {
+        std::cerr << "ShaderLibrary: cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+            out += line;
+            out += '\n';
+            continue;
+        }
+        size_t open = line.find('"', start + 8);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos) {
+            std::cerr << "ShaderLibrary: " << path << ":" << lineNumber << ": expected #include \"file\"" << std::endl;
+            return false;
+        }
+        std::string includePath = (std::filesystem::path(path).parent_path() / line.substr(open + 1, close - open - 1)).string();
+        out += "#line 1 " + std::to_string(included.size()) + "\n";
+        if (!expand(includePath, included, depth + 1, out)) return false;
+        out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+    }
+    return true;
+}
+
+unsigned int ShaderLibrary::build(const ShaderVariantSource& source, std::vector<std::string>& files) {
+    files.clear();
+    std::string vertexSource, fragmentSource;
+    bool vertexOk = preprocess(source.vertexPath, source.features, vertexSource, &files);
+    bool fragmentOk = preprocess(source.fragmentPath, source.features, fragmentSource, &files);
+    if (!vertexOk || !fragmentOk) return 0;
+    return programCache().build(vertexSource.c_str(), fragmentSource.c_str(),
+                                variantName(source.vertexPath, source.fragmentPath, source.features).c_str());
+}
+
+// Both stages are read even if one fails, so every file gets recorded
+bool ShaderLibrary::sources(Variant& variant, std::string& vertexSource, std::string& fragmentSource) {
+    ShaderVariantSource& source = variant.source;
+    source.files.clear();
+    bool vertexOk = preprocess(source.vertexPath, source.features, vertexSource, &source.files);
+    bool fragmentOk = preprocess(source.fragmentPath, source.features, fragmentSource, &source.files);
+    if (sourceListener) sourceListener(source);
+    return vertexOk && fragmentOk;
+}
@@ -0,0 +1,87 @@
+#ifndef SHADER_LIBRARY_HPP
+#define SHADER_LIBRARY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Feature bits of a shader variant; each set bit becomes "#define NAME 1".
+// Add a bit only together with the shader code and the draw state that use it:
+// a texture-coordinate bit, say, would come with a shader reading location 2
+// and the renderer choosing it from Mesh::hasTexCoords.
+enum ShaderFeature : uint32_t {
+    SHADER_SHADOWS = 1u << 0    // Sample the sun's shadow cascades
+};
+constexpr int SHADER_FEATURE_COUNT = 1;
+
+// What a variant is built from. files holds the canonical path of every
+// source and include of both stages, for hot reload.
+struct ShaderVariantSource {
+    uint64_t key = 0;
+    std::string vertexPath, fragmentPath;
+    uint32_t features = 0;
+    std::vector<std::string> files;
+};
+
+// File-based shader programs specialized by feature defines. Sources may
+// #include "path" (relative to the including file, each file at most once per
+// stage); the feature defines go right after #version. Every (vertex,
+// fragment, features) variant is hashed and built on first use through the
+// program cache, then kept until clear(). Render thread only, except
+// preprocess() and build(), which touch no state.
+struct ShaderLibrary {
+    // Program for a variant, built synchronously the first time; 0 if it
+    // failed (not retried until clear() or a hot reload)
+    unsigned int get(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features = 0);
+    // Submits a variant to the program cache's batch without waiting;
+    // onReady (optional) gets the program once ProgramCache::poll() has it,
+    // and again whenever replace() swaps in a reloaded one
+    void prewarm(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features = 0,
+                 std::function<void(unsigned int)> onReady = nullptr);
+    void clear(); // Deletes every variant's program
+
+    // Installs a rebuilt program for a ready variant, deletes the old one and
+    // calls the variant's onReady callbacks. False (program untouched) if the
+    // variant is gone or still building.
+    bool replace(uint64_t key, unsigned int program);
+    // Bumped by replace(); holders of get() programs re-resolve cached
+    // uniform locations when it changes
+    uint32_t generation() const { return reloads; }
+    // Called with each variant's sources when it is first built, and right
+    // away for the existing ones; the shader watcher watches them. Null stops.
+    void setSourceListener(std::function<void(const ShaderVariantSource&)> listener);
+
+    // Source with includes resolved and feature defines added. Files are read
+    // fresh every time; files (optional) gets every file read.
+    bool preprocess(const std::string& path, uint32_t features, std::string& out,
+                    std::vector<std::string>* files = nullptr);
+    // Preprocesses and links a variant's current sources through the program
+    // cache without touching the library, so any thread may call it; 0 on failure
+    unsigned int build(const ShaderVariantSource& source, std::vector<std::string>& files);
+
+    size_t variantCount() const { return variants.size(); }
+
+private:
+    struct Variant {
+        unsigned int program = 0;
+        bool ready = false; // False while a prewarm is pending
+        std::vector<std::function<void(unsigned int)>> listeners; // onReady callbacks, kept for reloads
+        ShaderVariantSource source;
+    };
+
+    std::unordered_map<uint64_t, Variant> variants;
+    std::function<void(const ShaderVariantSource&)> sourceListener;
+    uint32_t reloads = 0;
+
+    static uint64_t variantKey(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features);
+    bool expand(const std::string& path, std::unordered_set<std::string>& included, int depth, std::string& out);
+    static std::string variantName(const std::string& vertexPath, const std::string& fragmentPath, uint32_t features);
+    bool sources(Variant& variant, std::string& vertexSource, std::string& fragmentSource);
+};
+
+ShaderLibrary& shaderLibrary(); // Process-wide
+
+#endif
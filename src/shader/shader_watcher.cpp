@@ -0,0 +1,331 @@
+#include "shader_watcher.hpp"
+#include "program_cache.hpp"
+#include "shader_library.hpp"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string canonicalPath(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    return error ? path : canonical.string();
+}
+
+} // namespace
+
+bool ShaderWatcher::start(GLFWwindow* mainWindow) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context = glfwCreateWindow(1, 1, "Cisco Engine Shader Watcher", nullptr, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context) {
+        std::cerr << "Failed to create shared shader context; reloads compile on the render thread" << std::endl;
+    }
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) std::cerr << "inotify unavailable; polling shader files" << std::endl;
+#endif
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Target& target : targets) {
+            for (const std::string& file : target.source.files) watchFile(file);
+        }
+    }
+
+    quit = false;
+    thread = std::thread(&ShaderWatcher::threadLoop, this);
+    return context != nullptr;
+}
+
+void ShaderWatcher::stop() {
+    if (thread.joinable()) {
+        quit = true;
+        wake.notify_all();
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (ShaderLibrary* library : libraries) library->setSourceListener(nullptr);
+    libraries.clear();
+    fenced.insert(fenced.end(), finished.begin(), finished.end());
+    finished.clear();
+    for (Rebuild& rebuilt : fenced) {
+        glDeleteSync(rebuilt.fence);
+        glDeleteProgram(rebuilt.program);
+    }
+    fenced.clear();
+    dirty.clear();
+    if (context) {
+        glfwDestroyWindow(context);
+        context = nullptr;
+    }
+#ifdef __linux__
+    if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    inotifyFd = -1;
+    watchedDirectories.clear();
+}
+
+void ShaderWatcher::add(Shader* shader) {
+    Target target{{shader, nullptr, 0}, {}};
+    target.source.vertexPath = shader->vertexPath();
+    target.source.fragmentPath = shader->fragmentPath();
+    std::string unused;
+    shaderLibrary().preprocess(target.source.vertexPath, 0, unused, &target.source.files);
+    shaderLibrary().preprocess(target.source.fragmentPath, 0, unused, &target.source.files);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    addTarget(target);
+}
+
+void ShaderWatcher::remove(Shader* shader) {
+    TargetId id{shader, nullptr, 0};
+    std::lock_guard<std::mutex> lock(mutex);
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [&id](const Target& target) { return target.id == id; }),
+                  targets.end());
+    dirty.erase(std::remove(dirty.begin(), dirty.end(), id), dirty.end());
+    auto drop = [&id](std::vector<Rebuild>& list) {
+        list.erase(std::remove_if(list.begin(), list.end(), [&id](Rebuild& rebuilt) {
+            if (!(rebuilt.id == id)) return false;
+            glDeleteSync(rebuilt.fence);
+            glDeleteProgram(rebuilt.program);
+            return true;
+        }), list.end());
+    };
+    drop(finished);
+    drop(fenced);
+}
+
+void ShaderWatcher::watch(ShaderLibrary& library) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        libraries.push_back(&library);
+    }
+    ShaderLibrary* watched = &library;
+    library.setSourceListener([this, watched](const ShaderVariantSource& source) {
+        std::lock_guard<std::mutex> lock(mutex);
+        addTarget({{nullptr, watched, source.key}, source});
+    });
+}
+
+int ShaderWatcher::update() {
+    int swapped = 0;
+    if (!context) {
+        std::vector<Target> work;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            work = takeDirty();
+        }
+        for (const Target& target : work) {
+            std::vector<std::string> files;
+            unsigned int program = rebuild(target, files);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                refreshFiles(target.id, program != 0, files);
+            }
+            if (program && install(target.id, program)) swapped++;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        fenced.insert(fenced.end(), finished.begin(), finished.end());
+        finished.clear();
+    }
+    for (size_t i = 0; i < fenced.size();) {
+        GLenum status = glClientWaitSync(fenced[i].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            i++;
+            continue;
+        }
+        glDeleteSync(fenced[i].fence);
+        Rebuild rebuilt = fenced[i];
+        fenced.erase(fenced.begin() + i);
+        if (install(rebuilt.id, rebuilt.program)) swapped++;
+    }
+    return swapped;
+}
+
+// Compiles with the mutex released: the render thread's library calls reach
+// it through the source listener, and must not wait on a link
+void ShaderWatcher::threadLoop() {
+    if (context) glfwMakeContextCurrent(context);
+
+    while (!quit) {
+        waitForChanges();
+        if (!context) continue; // update() rebuilds on the render thread
+
+        std::vector<Target> work;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            work = takeDirty();
+        }
+        for (const Target& target : work) {
+            std::vector<std::string> files;
+            unsigned int program = rebuild(target, files);
+            GLsync fence = nullptr;
+            if (program) {
+                fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush(); // Make the fence visible to the render context
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            refreshFiles(target.id, program != 0, files);
+            if (program) finished.push_back({target.id, program, fence});
+        }
+    }
+
+    if (context) glfwMakeContextCurrent(nullptr);
+}
+
+// Caller holds mutex. A known target only has its files updated.
+void ShaderWatcher::addTarget(const Target& target) {
+    for (const std::string& file : target.source.files) watchFile(file);
+    if (Target* existing = findTarget(target.id)) {
+        existing->source = target.source;
+        return;
+    }
+    targets.push_back(target);
+}
+
+// Caller holds mutex
+ShaderWatcher::Target* ShaderWatcher::findTarget(const TargetId& id) {
+    for (Target& target : targets) {
+        if (target.id == id) return &target;
+    }
+    return nullptr;
+}
+
+// Caller holds mutex
+std::vector<ShaderWatcher::Target> ShaderWatcher::takeDirty() {
+    std::vector<Target> work;
+    for (const TargetId& id : dirty) {
+        if (Target* target = findTarget(id)) work.push_back(*target);
+    }
+    dirty.clear();
+    return work;
+}
+
+// Render thread, mutex not held: onReady callbacks may call into the library,
+// whose source listener locks it. Targets are only removed on this thread, so
+// one found here is still registered when its program is swapped in.
+bool ShaderWatcher::install(const TargetId& id, unsigned int program) {
+    std::string name;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Target* target = findTarget(id)) name = target->source.vertexPath + " + " + target->source.fragmentPath;
+    }
+    bool installed = false;
+    if (!name.empty() && id.shader) {
+        id.shader->replaceProgram(program);
+        installed = true;
+    } else if (!name.empty()) {
+        installed = id.library->replace(id.key, program);
+    }
+    if (!installed) {
+        glDeleteProgram(program); // Unregistered, cleared, or still building
+        return false;
+    }
+    std::cout << "Reloaded " << name << std::endl;
+    return true;
+}
+
+// Caller holds mutex
+void ShaderWatcher::watchFile(const std::string& path) {
+    std::string canonical = canonicalPath(path);
+    if (modified.count(canonical)) return;
+    std::error_code error;
+    modified[canonical] = std::filesystem::last_write_time(canonical, error);
+#ifdef __linux__
+    if (inotifyFd < 0) return;
+    // Watch the directory: editors often save by writing a new file and renaming it
+    std::string directory = std::filesystem::path(canonical).parent_path().string();
+    for (const auto& watched : watchedDirectories) {
+        if (watched.second == directory) return;
+    }
+    int watch = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch >= 0) watchedDirectories[watch] = directory;
+#endif
+}
+
+void ShaderWatcher::waitForChanges() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        pollfd descriptor = {inotifyFd, POLLIN, 0};
+        if (poll(&descriptor, 1, 100) <= 0) return; // Timeout also rechecks quit
+
+        // Let an editor finish writing before reading the events
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        alignas(inotify_event) char buffer[4096];
+        std::lock_guard<std::mutex> lock(mutex);
+        ssize_t bytes;
+        while ((bytes = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + bytes;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                auto directory = watchedDirectories.find(event->wd);
+                if (event->len > 0 && directory != watchedDirectories.end()) {
+                    markChanged(canonicalPath(directory->second + "/" + event->name));
+                }
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+        return;
+    }
+#endif
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait_for(lock, std::chrono::milliseconds(250));
+    for (auto& entry : modified) {
+        std::error_code error;
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(entry.first, error);
+        if (error || time == entry.second) continue;
+        entry.second = time;
+        markChanged(entry.first);
+    }
+}
+
+// Caller holds mutex. Any file a program was built from marks it, so editing
+// an include reloads every variant that uses it.
+void ShaderWatcher::markChanged(const std::string& path) {
+    for (const Target& target : targets) {
+        if (std::find(dirty.begin(), dirty.end(), target.id) != dirty.end()) continue;
+        const std::vector<std::string>& files = target.source.files;
+        if (std::find(files.begin(), files.end(), path) != files.end()) dirty.push_back(target.id);
+    }
+}
+
+// Mutex not held; works on a copy of the target. 0 keeps the current
+// program. files gets what the build read.
+unsigned int ShaderWatcher::rebuild(const Target& target, std::vector<std::string>& files) {
+    ShaderLibrary& library = target.id.library ? *target.id.library : shaderLibrary();
+    unsigned int program = library.build(target.source, files);
+    if (!program) {
+        std::cerr << "Keeping the previous program for " << target.source.vertexPath << " + "
+                  << target.source.fragmentPath << std::endl;
+    }
+    return program;
+}
+
+// Caller holds mutex. The file list is refreshed, since includes may have
+// been added or removed; a target removed meanwhile is skipped.
+void ShaderWatcher::refreshFiles(const TargetId& id, bool built, const std::vector<std::string>& files) {
+    Target* target = findTarget(id);
+    if (!target) return;
+    if (built) {
+        target->source.files = files;
+    } else {
+        // A broken file may have hidden later includes; keep watching the old ones too
+        for (const std::string& file : files) {
+            if (std::find(target->source.files.begin(), target->source.files.end(), file) == target->source.files.end()) {
+                target->source.files.push_back(file);
+            }
+        }
+    }
+    for (const std::string& file : target->source.files) watchFile(file);
+}
@@ -0,0 +1,91 @@
+#ifndef SHADER_WATCHER_HPP
+#define SHADER_WATCHER_HPP
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "shader.hpp"
+#include "shader_library.hpp"
+
+struct GLFWwindow;
+
+// Hot reload for file-based programs: ShaderLibrary variants and Shaders. A
+// background thread watches every file a program was built from, includes
+// too (inotify on Linux, modification times elsewhere), and rebuilds a
+// changed program through the library's preprocessor and the program cache
+// in its own GL context shared with the main window, as UploadThread does
+// for buffers. update() swaps a rebuilt program in once its fence has
+// signalled: a Shader replaces its program and bumps its generation, a
+// library variant goes through ShaderLibrary::replace(), which hands it to
+// the variant's onReady callbacks. When compiling or linking fails the
+// previous program stays in use and the error log is printed.
+struct ShaderWatcher {
+    // Main thread: creates a hidden 1x1 window sharing mainWindow's objects.
+    // Without it changes are still detected but rebuilt in update().
+    bool start(GLFWwindow* mainWindow);
+    void stop(); // Also stops listening to watched libraries
+
+    // Render thread; the shader must outlive its registration
+    void add(Shader* shader);
+    void remove(Shader* shader);
+    // Render thread: watches the library's variants, those built later too;
+    // the library must outlive stop()
+    void watch(ShaderLibrary& library);
+    int update(); // Once per frame; returns the number of programs swapped in
+
+private:
+    // Variant keys are only unique within a library, and neither may be
+    // confused with a Shader, so a target is named by its owner too
+    struct TargetId {
+        Shader* shader = nullptr;        // Set for Shaders
+        ShaderLibrary* library = nullptr; // Set, with key, for library variants
+        uint64_t key = 0;
+        bool operator==(const TargetId& other) const {
+            return shader == other.shader && library == other.library && key == other.key;
+        }
+    };
+    struct Target {
+        TargetId id;
+        ShaderVariantSource source;  // files: what the current program was built from
+    };
+    struct Rebuild {
+        TargetId id;
+        unsigned int program;
+        GLsync fence;
+    };
+
+    GLFWwindow* context = nullptr;
+    std::thread thread;
+    std::atomic<bool> quit{false};
+    std::condition_variable wake;
+
+    std::mutex mutex;                      // Guards the members below
+    std::vector<Target> targets;
+    std::vector<ShaderLibrary*> libraries;
+    std::vector<TargetId> dirty;           // Changed targets, waiting for a rebuild
+    std::vector<Rebuild> finished;         // Rebuilt, fence not yet checked
+    std::unordered_map<std::string, std::filesystem::file_time_type> modified; // Polling
+    int inotifyFd = -1;
+    std::unordered_map<int, std::string> watchedDirectories; // inotify watch -> directory
+
+    std::vector<Rebuild> fenced;           // Render thread only
+
+    void threadLoop();
+    void addTarget(const Target& target);  // Caller holds mutex
+    Target* findTarget(const TargetId& id);
+    std::vector<Target> takeDirty();       // Caller holds mutex; copies, so rebuilds run unlocked
+    bool install(const TargetId& id, unsigned int program); // False: target gone, program deleted
+    void watchFile(const std::string& path);
+    void waitForChanges();                 // Fills dirty
+    void markChanged(const std::string& path);
+    unsigned int rebuild(const Target& target, std::vector<std::string>& files); // Mutex not held
+    void refreshFiles(const TargetId& id, bool built, const std::vector<std::string>& files);
+};
+
+#endif
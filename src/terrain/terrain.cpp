@@ -0,0 +1,347 @@
+#include "terrain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "../shader/program_cache.hpp"
+
+namespace {
+
+const char* terrainVertexSource =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 aGrid;\n"
+    "uniform vec4 node;\n"        // x, z, size
+    "uniform vec2 morph;\n"       // Distance where morphing starts, ends
+    "uniform vec3 eye;\n"
+    "uniform vec4 terrain;\n"     // origin xyz, size
+    "uniform vec4 grid;\n"        // resolution, heightScale, 1/width, 1/height
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "uniform sampler2D heightmap;\n"
+    "out vec3 FragPos;\n"
+    "out vec3 Normal;\n"
+    "float heightAt(vec2 uv) {\n"      // uv in [0, 1] over the terrain
+    "    vec2 texel = uv * (1.0 - grid.zw) + 0.5 * grid.zw;\n" // (uv * (w - 1) + 0.5) / w, as Terrain::heightAt
+    "    return textureLod(heightmap, texel, 0.0).r * grid.y + terrain.y;\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 world = node.xy + aGrid * node.z;\n"
+    "    vec2 uv = (world - terrain.xz) / terrain.w;\n"
+    "    float dist = distance(eye, vec3(world.x, heightAt(uv), world.y));\n"
+    "    float k = clamp((dist - morph.x) / (morph.y - morph.x), 0.0, 1.0);\n"
+    "    vec2 odd = fract(aGrid * grid.x * 0.5) * 2.0 / grid.x;\n" // Offset to the coarser grid
+    "    world = node.xy + (aGrid - odd * k) * node.z;\n"
+    "    uv = (world - terrain.xz) / terrain.w;\n"
+    "    vec2 spacing = grid.zw / (1.0 - grid.zw);\n" // One heightmap sample in uv: 1 / (w - 1)
+    "    float h = heightAt(uv);\n"
+    "    float hl = heightAt(uv - vec2(spacing.x, 0.0));\n"
+    "    float hr = heightAt(uv + vec2(spacing.x, 0.0));\n"
+    "    float hd = heightAt(uv - vec2(0.0, spacing.y));\n"
+    "    float hu = heightAt(uv + vec2(0.0, spacing.y));\n"
+    "    Normal = normalize(vec3((hl - hr) * spacing.y, 2.0 * spacing.x * spacing.y * terrain.w, (hd - hu) * spacing.x));\n" // Central differences, each axis over its own spacing
+    "    FragPos = vec3(world.x, h, world.y);\n"
+    "    gl_Position = projection * view * vec4(FragPos, 1.0);\n"
+    "}\n";
+
+const char* terrainFragmentSource =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "in vec3 FragPos;\n"
+    "in vec3 Normal;\n"
+    "uniform vec3 lightDir;\n"
+    "uniform vec3 lightColor;\n"
+    "void main() {\n"
+    "    vec3 norm = normalize(Normal);\n"
+    "    float diff = max(dot(norm, normalize(-lightDir)), 0.0);\n"
+    "    vec3 rock = vec3(0.45, 0.42, 0.38);\n"
+    "    vec3 grass = vec3(0.32, 0.5, 0.26);\n"
+    "    vec3 base = mix(rock, grass, smoothstep(0.7, 0.9, norm.y));\n"
+    "    FragColor = vec4(base * (vec3(0.35) + diff * lightColor), 1.0);\n"
+    "}\n";
+
+// Squared distance from a point to a box, compared against a radius
+bool boxInSphere(vec3 lo, vec3 hi, vec3 center, float radius) {
+    float dx = std::fmax(std::fmax(lo.x - center.x, 0.0f), center.x - hi.x);
+    float dy = std::fmax(std::fmax(lo.y - center.y, 0.0f), center.y - hi.y);
+    float dz = std::fmax(std::fmax(lo.z - center.z, 0.0f), center.z - hi.z);
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+uint32_t hashLattice(int x, int z, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(z) * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return h ^ (h >> 16);
+}
+
+float valueNoise(float x, float z, uint32_t seed) {
+    int xi = static_cast<int>(std::floor(x)), zi = static_cast<int>(std::floor(z));
+    float fx = x - xi, fz = z - zi;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fz = fz * fz * (3.0f - 2.0f * fz);
+    auto corner = [&](int dx, int dz) { return (hashLattice(xi + dx, zi + dz, seed) & 0xffff) / 65535.0f; };
+    float a = corner(0, 0) + (corner(1, 0) - corner(0, 0)) * fx;
+    float b = corner(0, 1) + (corner(1, 1) - corner(0, 1)) * fx;
+    return a + (b - a) * fz;
+}
+
+} // namespace
+
+bool Terrain::loadHeightmapR16(const std::string& filename, int width, int height) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() != static_cast<size_t>(width) * height * 2) {
+        std::cerr << "Terrain: " << filename << " is not a " << width << "x" << height << " 16-bit heightmap" << std::endl;
+        return false;
+    }
+    heightmapWidth = width;
+    heightmapHeight = height;
+    heights.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < heights.size(); i++) {
+        heights[i] = static_cast<uint16_t>(bytes[i * 2] | (bytes[i * 2 + 1] << 8));
+    }
+    return true;
+}
+
+void Terrain::generateHeightmap(int resolution, uint32_t seed) {
+    heightmapWidth = heightmapHeight = resolution;
+    std::vector<float> values(static_cast<size_t>(resolution) * resolution);
+    float lo = 1e30f, hi = -1e30f;
+    for (int z = 0; z < resolution; z++) {
+        for (int x = 0; x < resolution; x++) {
+            float value = 0.0f, amplitude = 1.0f, frequency = 4.0f / resolution;
+            for (int octave = 0; octave < 6; octave++) {
+                value += valueNoise(x * frequency, z * frequency, seed + octave) * amplitude;
+                amplitude *= 0.5f;
+                frequency *= 2.0f;
+            }
+            values[static_cast<size_t>(z) * resolution + x] = value;
+            lo = std::fmin(lo, value);
+            hi = std::fmax(hi, value);
+        }
+    }
+    heights.resize(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        heights[i] = static_cast<uint16_t>((values[i] - lo) / (hi - lo) * 65535.0f);
+    }
+}
+
+bool Terrain::init() {
+    if (heights.empty()) {
+        std::cerr << "Terrain: no heightmap" << std::endl;
+        return false;
+    }
+    if (settings.gridResolution % 2 != 0) settings.gridResolution++;
+
+    // Uniforms are resolved once the program cache has the program linked
+    programCache().submit(terrainVertexSource, terrainFragmentSource, "Terrain", [this](unsigned int linked) {
+        program = linked;
+        if (!program) return;
+        uniformNode = glGetUniformLocation(program, "node");
+        uniformMorph = glGetUniformLocation(program, "morph");
+        uniformEye = glGetUniformLocation(program, "eye");
+        uniformTerrain = glGetUniformLocation(program, "terrain");
+        uniformGrid = glGetUniformLocation(program, "grid");
+        uniformView = glGetUniformLocation(program, "view");
+        uniformProjection = glGetUniformLocation(program, "projection");
+        uniformHeightmap = glGetUniformLocation(program, "heightmap");
+        uniformLightDir = glGetUniformLocation(program, "lightDir");
+        uniformLightColor = glGetUniformLocation(program, "lightColor");
+    });
+
+    glGenTextures(1, &heightTexture);
+    glBindTexture(GL_TEXTURE_2D, heightTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, heightmapWidth, heightmapHeight, 0, GL_RED, GL_UNSIGNED_SHORT, heights.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // One grid shared by every chunk; indices grouped by quadrant so a
+    // quarter of a node is a contiguous range
+    int g = settings.gridResolution;
+    std::vector<float> vertices;
+    vertices.reserve(static_cast<size_t>(g + 1) * (g + 1) * 2);
+    for (int z = 0; z <= g; z++) {
+        for (int x = 0; x <= g; x++) {
+            vertices.push_back(static_cast<float>(x) / g);
+            vertices.push_back(static_cast<float>(z) / g);
+        }
+    }
+    std::vector<unsigned int> indices;
+    int half = g / 2;
+    for (int q = 0; q < 4; q++) {
+        int x0 = (q & 1) * half, z0 = (q >> 1) * half;
+        for (int z = z0; z < z0 + half; z++) {
+            for (int x = x0; x < x0 + half; x++) {
+                unsigned int topLeft = z * (g + 1) + x;
+                unsigned int bottomLeft = (z + 1) * (g + 1) + x;
+                indices.insert(indices.end(), {topLeft, bottomLeft, topLeft + 1, topLeft + 1, bottomLeft, bottomLeft + 1});
+            }
+        }
+    }
+    quadrantIndexCount = half * half * 6;
+
+    glGenVertexArrays(1, &gridVAO);
+    glGenBuffers(1, &gridVBO);
+    glGenBuffers(1, &gridEBO);
+    glBindVertexArray(gridVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
+    // Distance bands, doubling per level; the coarsest covers the whole terrain
+    ranges.resize(settings.lodLevels);
+    for (int i = 0; i < settings.lodLevels; i++) {
+        ranges[i] = i == 0 ? settings.finestRange : ranges[i - 1] * 2.0f;
+    }
+    ranges.back() = std::fmax(ranges.back(), settings.size * 2.0f);
+
+    buildMinMax();
+    return true;
+}
+
+void Terrain::cleanup() {
+    if (program) glDeleteProgram(program);
+    if (heightTexture) glDeleteTextures(1, &heightTexture);
+    if (gridVAO) glDeleteVertexArrays(1, &gridVAO);
+    if (gridVBO) glDeleteBuffers(1, &gridVBO);
+    if (gridEBO) glDeleteBuffers(1, &gridEBO);
+    program = heightTexture = gridVAO = gridVBO = gridEBO = 0;
+}
+
+// Min/max height of every quadtree node, leaves from the heightmap and
+// parents from their children, for node bounding boxes
+void Terrain::buildMinMax() {
+    int leafDepth = settings.lodLevels - 1;
+    minMax.assign(settings.lodLevels, std::vector<float>());
+    int leaves = 1 << leafDepth;
+    std::vector<float>& leaf = minMax[leafDepth];
+    leaf.resize(static_cast<size_t>(leaves) * leaves * 2);
+    for (int nz = 0; nz < leaves; nz++) {
+        for (int nx = 0; nx < leaves; nx++) {
+            int x0 = nx * (heightmapWidth - 1) / leaves, x1 = ((nx + 1) * (heightmapWidth - 1) + leaves - 1) / leaves;
+            int z0 = nz * (heightmapHeight - 1) / leaves, z1 = ((nz + 1) * (heightmapHeight - 1) + leaves - 1) / leaves;
+            uint16_t lo = 65535, hi = 0;
+            for (int z = z0; z <= z1; z++) {
+                for (int x = x0; x <= x1; x++) {
+                    uint16_t h = heights[static_cast<size_t>(z) * heightmapWidth + x];
+                    lo = std::min(lo, h);
+                    hi = std::max(hi, h);
+                }
+            }
+            size_t i = (static_cast<size_t>(nz) * leaves + nx) * 2;
+            leaf[i] = lo / 65535.0f * settings.heightScale;
+            leaf[i + 1] = hi / 65535.0f * settings.heightScale;
+        }
+    }
+    for (int depth = leafDepth - 1; depth >= 0; depth--) {
+        int n = 1 << depth;
+        const std::vector<float>& child = minMax[depth + 1];
+        std::vector<float>& level = minMax[depth];
+        level.resize(static_cast<size_t>(n) * n * 2);
+        for (int nz = 0; nz < n; nz++) {
+            for (int nx = 0; nx < n; nx++) {
+                float lo = 1e30f, hi = -1e30f;
+                for (int q = 0; q < 4; q++) {
+                    size_t c = (static_cast<size_t>(nz * 2 + (q >> 1)) * n * 2 + nx * 2 + (q & 1)) * 2;
+                    lo = std::fmin(lo, child[c]);
+                    hi = std::fmax(hi, child[c + 1]);
+                }
+                size_t i = (static_cast<size_t>(nz) * n + nx) * 2;
+                level[i] = lo;
+                level[i + 1] = hi;
+            }
+        }
+    }
+}
+
+size_t Terrain::select(vec3 eye, const Frustum& frustum, TerrainChunk* out, size_t capacity) const {
+    size_t count = 0;
+    if (!minMax.empty()) selectNode(0, 0, 0, eye, frustum, out, capacity, count);
+    return count;
+}
+
+// Returns false when the node is beyond its LOD's range, so the caller covers
+// that area at its own, coarser level
+bool Terrain::selectNode(int depth, int nodeX, int nodeZ, vec3 eye, const Frustum& frustum,
+                         TerrainChunk* out, size_t capacity, size_t& count) const {
+    int lod = settings.lodLevels - 1 - depth;
+    float nodeSize = settings.size / (1 << depth);
+    size_t i = (static_cast<size_t>(nodeZ) * (1 << depth) + nodeX) * 2;
+    vec3 lo = {settings.origin.x + nodeX * nodeSize, settings.origin.y + minMax[depth][i], settings.origin.z + nodeZ * nodeSize};
+    vec3 hi = {lo.x + nodeSize, settings.origin.y + minMax[depth][i + 1], lo.z + nodeSize};
+
+    if (!boxInSphere(lo, hi, eye, ranges[lod])) return false;
+    if (!frustumIntersectsAabb(frustum, lo, hi)) return true; // Culled, but handled
+
+    auto emit = [&](uint8_t quadrant) {
+        if (count < capacity) out[count++] = {lo.x, lo.z, nodeSize, static_cast<uint8_t>(lod), quadrant};
+    };
+    if (lod == 0 || !boxInSphere(lo, hi, eye, ranges[lod - 1])) {
+        emit(4);
+        return true;
+    }
+    for (int q = 0; q < 4; q++) {
+        if (!selectNode(depth + 1, nodeX * 2 + (q & 1), nodeZ * 2 + (q >> 1), eye, frustum, out, capacity, count)) {
+            emit(static_cast<uint8_t>(q));
+        }
+    }
+    return true;
+}
+
+void Terrain::render(const mat4& view, const mat4& projection, vec3 eye, const LightComponent& sun,
+                     const TerrainChunk* chunks, size_t count) const {
+    if (!program || count == 0) return;
+    glUseProgram(program);
+    glUniformMatrix4fv(uniformView, 1, GL_FALSE, view.m);
+    glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, projection.m);
+    glUniform3f(uniformEye, eye.x, eye.y, eye.z);
+    glUniform4f(uniformTerrain, settings.origin.x, settings.origin.y, settings.origin.z, settings.size);
+    glUniform4f(uniformGrid, static_cast<float>(settings.gridResolution), settings.heightScale,
+                1.0f / heightmapWidth, 1.0f / heightmapHeight);
+    glUniform3f(uniformLightDir, sun.direction.x, sun.direction.y, sun.direction.z);
+    vec3 lightColor = sun.color * sun.intensity;
+    glUniform3f(uniformLightColor, lightColor.x, lightColor.y, lightColor.z);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, heightTexture);
+    glUniform1i(uniformHeightmap, 0);
+    glBindVertexArray(gridVAO);
+
+    for (size_t c = 0; c < count; c++) {
+        const TerrainChunk& chunk = chunks[c];
+        float low = chunk.lodLevel == 0 ? 0.0f : ranges[chunk.lodLevel - 1];
+        float high = ranges[chunk.lodLevel];
+        glUniform4f(uniformNode, chunk.x, chunk.z, chunk.size, 0.0f);
+        glUniform2f(uniformMorph, low + (high - low) * settings.morphStart, high);
+        if (chunk.quadrant == 4) {
+            glDrawElements(GL_TRIANGLES, quadrantIndexCount * 4, GL_UNSIGNED_INT, 0);
+        } else {
+            glDrawElements(GL_TRIANGLES, quadrantIndexCount, GL_UNSIGNED_INT,
+                           (void*)(chunk.quadrant * quadrantIndexCount * sizeof(unsigned int)));
+        }
+    }
+    glBindVertexArray(0);
+}
+
+float Terrain::heightAt(float x, float z) const {
+    if (heights.empty()) return settings.origin.y;
+    float u = std::fmin(std::fmax((x - settings.origin.x) / settings.size, 0.0f), 1.0f) * (heightmapWidth - 1);
+    float v = std::fmin(std::fmax((z - settings.origin.z) / settings.size, 0.0f), 1.0f) * (heightmapHeight - 1);
+    int x0 = std::min(static_cast<int>(u), heightmapWidth - 2), z0 = std::min(static_cast<int>(v), heightmapHeight - 2);
+    float fx = u - x0, fz = v - z0;
+    auto h = [&](int dx, int dz) { return heights[static_cast<size_t>(z0 + dz) * heightmapWidth + x0 + dx] / 65535.0f; };
+    float a = h(0, 0) + (h(1, 0) - h(0, 0)) * fx;
+    float b = h(0, 1) + (h(1, 1) - h(0, 1)) * fx;
+    return settings.origin.y + (a + (b - a) * fz) * settings.heightScale;
+}
@@ -0,0 +1,76 @@
+#ifndef TERRAIN_HPP
+#define TERRAIN_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../math/math.hpp"
+#include "../scene/components.hpp"
+
+struct TerrainSettings {
+    vec3 origin = {-512.0f, -40.0f, -512.0f}; // Minimum corner (height 0)
+    float size = 1024.0f;          // World units along x and z
+    float heightScale = 32.0f;     // World height of the heightmap's maximum
+    int gridResolution = 32;       // Quads along a chunk edge; even
+    int lodLevels = 7;             // Quadtree depth; chunk size halves per level
+    float finestRange = 24.0f;     // View distance covered by LOD 0; doubles per level
+    float morphStart = 0.7f;       // Fraction of a LOD's range where morphing begins
+    int maxChunks = 1024;
+};
+
+// One selected quadtree node. quadrant 0-3 draws a quarter of the node's grid
+// (children not selected at the finer level), 4 the whole grid.
+struct TerrainChunk {
+    float x, z, size;
+    uint8_t lodLevel;
+    uint8_t quadrant;
+};
+
+// CDLOD terrain: a quadtree over a heightmap, selected each frame by distance
+// bands around the camera and culled per node against the frustum. Every
+// chunk draws the same grid mesh; the vertex shader displaces it from the
+// heightmap texture and morphs vertices toward the next coarser grid near the
+// edge of each band, so the vertex count stays roughly constant with view
+// distance and LOD transitions have no cracks or pops.
+struct Terrain {
+    TerrainSettings settings;
+
+    // Heightmap, row-major, normalized 0-65535
+    int heightmapWidth = 0, heightmapHeight = 0;
+    std::vector<uint16_t> heights;
+
+    // 16-bit little-endian raw heightmap (.r16/.raw)
+    bool loadHeightmapR16(const std::string& filename, int width, int height);
+    // Fractal value noise, for scenes without a heightmap
+    void generateHeightmap(int resolution, uint32_t seed);
+
+    bool init();   // GL resources and min/max tree; after a heightmap is set
+    void cleanup();
+
+    // Update thread: selected chunks into out (at most capacity), returns the count
+    size_t select(vec3 eye, const Frustum& frustum, TerrainChunk* out, size_t capacity) const;
+    // Render thread
+    void render(const mat4& view, const mat4& projection, vec3 eye, const LightComponent& sun,
+                const TerrainChunk* chunks, size_t count) const;
+
+    float heightAt(float x, float z) const; // World height, bilinear
+
+private:
+    unsigned int program = 0;
+    unsigned int heightTexture = 0;
+    unsigned int gridVAO = 0, gridVBO = 0, gridEBO = 0;
+    int quadrantIndexCount = 0;
+    std::vector<float> ranges;             // Per LOD level, finest first
+    std::vector<std::vector<float>> minMax; // Per quadtree depth: min, max per node
+
+    int uniformNode = -1, uniformMorph = -1, uniformEye = -1, uniformView = -1, uniformProjection = -1;
+    int uniformTerrain = -1, uniformHeightmap = -1, uniformGrid = -1, uniformLightDir = -1, uniformLightColor = -1;
+
+    void buildMinMax();
+    bool selectNode(int depth, int nodeX, int nodeZ, vec3 eye, const Frustum& frustum,
+                    TerrainChunk* out, size_t capacity, size_t& count) const;
+};
+
+#endif